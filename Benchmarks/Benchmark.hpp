@@ -0,0 +1,107 @@
+//
+//  Benchmark.hpp
+//  Benchmarks
+//  Minimal timing harness with JSON and CSV output
+//  Created by Kevin on 10/18/26.
+//
+//  A case is a callable that processes `items` units of work (options, paths,
+//  normals) per call. Run() calls it until MinTime has passed, repeats that
+//  Repetitions times and keeps the median, so one slow repetition does not
+//  move the result. Records are kept in the order they were run, so two
+//  result files of the same build options diff line by line.
+//
+
+#ifndef Benchmark_hpp
+#define Benchmark_hpp
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+struct BenchmarkRecord {
+    string name;       // group/case, e.g. "european/batch_price"
+    size_t size;       // batch size, paths or draws per call
+    size_t threads;    // participating threads, 1 for single-threaded code
+    string unit;       // what one op is: option, path, normal
+    long iterations;   // calls in the median repetition
+    double nsPerOp;    // wall time per unit
+    double opsPerSec;  // units per second
+};
+
+class BenchmarkRunner {
+private:
+    vector<BenchmarkRecord> records;
+    string filter;     // substring a case name must contain, empty runs all
+    volatile double sink = 0.0;
+
+public:
+    double MinTime = 0.2;  // seconds per repetition
+    int Repetitions = 3;
+
+    explicit BenchmarkRunner(const string& filter = ""): filter(filter) {}
+
+    bool Selected(const string& name) const { return filter.empty() || name.find(filter) != string::npos; }
+
+    // Keep a result alive so the optimiser cannot drop the work
+    void Consume(double x) { sink = sink + x; }
+
+    template <class F>
+    void Run(const string& name, size_t size, size_t threads, const string& unit, double items, F body)
+    {
+        if (!Selected(name))
+            return;
+        typedef chrono::steady_clock Clock;
+        body(); // warm up caches, pools and lazy tables
+
+        vector<pair<double, long>> reps; // seconds per call, calls
+        for (int rep = 0; rep < Repetitions; rep++) {
+            long calls = 0;
+            Clock::time_point start = Clock::now();
+            double elapsed = 0.0;
+            do {
+                body();
+                calls++;
+                elapsed = chrono::duration<double>(Clock::now() - start).count();
+            } while (elapsed < MinTime);
+            reps.push_back({elapsed / calls, calls});
+        }
+        sort(reps.begin(), reps.end());
+        pair<double, long> median = reps[reps.size() / 2];
+
+        BenchmarkRecord record{name, size, threads, unit, median.second, 1e9 * median.first / items, items / median.first};
+        records.push_back(record);
+        fprintf(stderr, "%-36s %9zu %3zu  %12.2f ns/%s  %14.0f %s/s\n", name.c_str(), size, threads,
+                record.nsPerOp, unit.c_str(), record.opsPerSec, unit.c_str());
+    }
+
+    const vector<BenchmarkRecord>& Records() const { return records; }
+
+    void WriteJson(FILE* out, const vector<pair<string, string>>& context) const
+    {
+        fprintf(out, "{\n  \"context\": {");
+        for (size_t i = 0; i < context.size(); i++)
+            fprintf(out, "%s\n    \"%s\": \"%s\"", i ? "," : "", context[i].first.c_str(), context[i].second.c_str());
+        fprintf(out, "\n  },\n  \"benchmarks\": [");
+        for (size_t i = 0; i < records.size(); i++) {
+            const BenchmarkRecord& r = records[i];
+            fprintf(out, "%s\n    {\"name\": \"%s\", \"size\": %zu, \"threads\": %zu, \"unit\": \"%s\", "
+                    "\"iterations\": %ld, \"ns_per_op\": %.4g, \"ops_per_s\": %.6g}",
+                    i ? "," : "", r.name.c_str(), r.size, r.threads, r.unit.c_str(), r.iterations, r.nsPerOp, r.opsPerSec);
+        }
+        fprintf(out, "\n  ]\n}\n");
+    }
+
+    void WriteCsv(FILE* out) const
+    {
+        fprintf(out, "name,size,threads,unit,iterations,ns_per_op,ops_per_s\n");
+        for (const BenchmarkRecord& r : records)
+            fprintf(out, "%s,%zu,%zu,%s,%ld,%.4g,%.6g\n", r.name.c_str(), r.size, r.threads, r.unit.c_str(),
+                    r.iterations, r.nsPerOp, r.opsPerSec);
+    }
+};
+
+#endif /* Benchmark_hpp */
@@ -0,0 +1,361 @@
+//
+//  main.cpp
+//  Benchmarks
+//  Throughput of every pricing path across batch sizes and thread counts
+//  Created by Kevin on 10/18/26.
+//
+//  pricing_bench [--filter text] [--format json|csv] [--out file] [--quick]
+//                [--min-time seconds] [--threads 1,2,4] [--sizes 1000,100000]
+//
+//  Results go to stdout (or --out) as JSON by default, progress to stderr.
+//  The inputs are drawn from a fixed seed, so runs of two releases price the
+//  same options and their result files can be diffed.
+//
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Benchmark.hpp"
+// Group A & B
+#include "EuropeanOption.hpp"
+#include "PerpetualAmericanOptions.hpp"
+#include "BatchPricer.hpp"
+#include "PerpetualBatchPricer.hpp"
+#include "ImpliedVolSolver.hpp"
+#include "ScenarioGrid.hpp"
+#include "Portfolio.hpp"
+// Group C & D
+#include "MonteCarloEngine.hpp"
+#include "FDMEngine.hpp"
+#include "NormalGenerator.hpp"
+
+using namespace std;
+
+static vector<size_t> ParseList(const char* text)
+{
+    vector<size_t> values;
+    stringstream in(text);
+    string item;
+    while (getline(in, item, ','))
+        values.push_back(strtoul(item.c_str(), nullptr, 10));
+    return values;
+}
+
+// Row-major {T, K, sig, r, b, S} rows around the main.cpp test batches
+static vector<vector<double>> EuropeanMatrix(size_t n)
+{
+    mt19937_64 gen(20261018);
+    uniform_real_distribution<double> u(0.0, 1.0);
+    vector<vector<double>> rows(n);
+    for (size_t i = 0; i < n; i++) {
+        double r = 0.08 * u(gen);
+        rows[i] = {0.1 + 2.0 * u(gen), 60.0 + 60.0 * u(gen), 0.1 + 0.5 * u(gen), r, r - 0.02 * u(gen), 60.0 + 60.0 * u(gen)};
+    }
+    return rows;
+}
+
+// Row-major {K, sig, r, b, S}, b < r so the call exponent is above one
+static vector<vector<double>> PerpetualMatrix(size_t n)
+{
+    vector<vector<double>> rows = EuropeanMatrix(n);
+    for (vector<double>& row : rows)
+        row = {row[1], row[2], row[3] + 0.01, row[4], row[5]};
+    return rows;
+}
+
+static OptionData MonteCarloData()
+{ // Batch 1 of the Group D tests
+    OptionData data;
+    data.K = 65.0;
+    data.T = 0.25;
+    data.r = 0.08;
+    data.sig = 0.3;
+    data.D = 0.0;
+    data.H = 0.0;
+    data.betaCEV = 1.0;
+    data.scale = 1.0;
+    data.S = 60.0;
+    data.type = -1;
+    return data;
+}
+
+static void EuropeanCases(BenchmarkRunner& bench, const vector<size_t>& sizes, const vector<size_t>& threads,
+                          vector<unique_ptr<ThreadPool>>& pools)
+{
+    for (size_t n : sizes) {
+        vector<vector<double>> matrix = EuropeanMatrix(n);
+        vector<EuropeanOption> options;
+        options.reserve(n);
+        for (const vector<double>& row : matrix)
+            options.emplace_back(row[0], row[1], row[2], row[3], row[4], row[5], n % 2 ? Put : Call);
+
+        bench.Run("european/price", n, 1, "option", n, [&]() {
+            double sum = 0.0;
+            for (const EuropeanOption& o : options) sum += o.Price();
+            bench.Consume(sum);
+        });
+        bench.Run("european/delta", n, 1, "option", n, [&]() {
+            double sum = 0.0;
+            for (const EuropeanOption& o : options) sum += o.Delta();
+            bench.Consume(sum);
+        });
+        bench.Run("european/gamma", n, 1, "option", n, [&]() {
+            double sum = 0.0;
+            for (const EuropeanOption& o : options) sum += o.Gamma();
+            bench.Consume(sum);
+        });
+        bench.Run("european/delta_fd", n, 1, "option", n, [&]() {
+            double sum = 0.0;
+            for (const EuropeanOption& o : options) sum += o.Delta(0.01);
+            bench.Consume(sum);
+        });
+        bench.Run("european/gamma_fd", n, 1, "option", n, [&]() {
+            double sum = 0.0;
+            for (const EuropeanOption& o : options) sum += o.Gamma(0.01);
+            bench.Consume(sum);
+        });
+
+        EuropeanOption book(matrix, "C");
+        for (const char* mode : {"price", "delta", "gamma"})
+            for (size_t t = 0; t < threads.size(); t++)
+                bench.Run(string("european/option_matrix_") + mode, n, threads[t], "option", n, [&]() {
+                    bench.Consume(book.optionMatrix(mode, pools[t].get())[0]);
+                });
+
+        // the kernels behind optionMatrix, without the transpose, per thread count
+        EuropeanColumns columns(matrix, Call);
+        EuropeanBatch batch = columns.Batch();
+        vector<double> price(n), delta(n), gamma(n), sig(n);
+        for (size_t t = 0; t < threads.size(); t++) {
+            EuropeanBatchPricer pricer(simd::DetectSimdLevel(), pools[t].get());
+            bench.Run("european/batch_price_greeks", n, threads[t], "option", n, [&]() {
+                pricer.Compute(batch, BatchResult{price, delta, gamma});
+                bench.Consume(price[0]);
+            });
+        }
+
+        ImpliedVolBatch quotes{batch.T, batch.K, batch.r, batch.b, batch.S, price, {}};
+        for (size_t t = 0; t < threads.size(); t++) {
+            ImpliedVolSolver solver(simd::DetectSimdLevel(), pools[t].get());
+            bench.Run("european/implied_vol", n, threads[t], "option", n, [&]() {
+                solver.Compute(quotes, ImpliedVolResult{sig, {}});
+                bench.Consume(sig[0]);
+            });
+        }
+    }
+}
+
+static void PerpetualCases(BenchmarkRunner& bench, const vector<size_t>& sizes, const vector<size_t>& threads,
+                           vector<unique_ptr<ThreadPool>>& pools)
+{
+    for (size_t n : sizes) {
+        vector<vector<double>> matrix = PerpetualMatrix(n);
+        PerpetualAmericanOption book(matrix, "C");
+        for (size_t t = 0; t < threads.size(); t++)
+            bench.Run("perpetual/price_with_matrix", n, threads[t], "option", n, [&]() {
+                bench.Consume(book.PriceWithMatrix(pools[t].get())[0]);
+            });
+
+        PerpetualColumns columns(matrix, Call);
+        vector<double> price(n);
+        for (size_t t = 0; t < threads.size(); t++) {
+            PerpetualAmericanBatchPricer pricer(simd::DetectSimdLevel(), pools[t].get());
+            bench.Run("perpetual/batch_price", n, threads[t], "option", n, [&]() {
+                pricer.Compute(columns.Batch(), PerpetualBatchResult{price, {}, {}, {}});
+                bench.Consume(price[0]);
+            });
+        }
+    }
+}
+
+// Spot x vol x time ladders of n options, 64 x 16 x 16 shifts each
+static void ScenarioCases(BenchmarkRunner& bench, const vector<size_t>& sizes, const vector<size_t>& threads,
+                          vector<unique_ptr<ThreadPool>>& pools)
+{
+    ScenarioAxes axes;
+    axes.S = {meshArray(0.68, 1.31, 0.01), AxisKind::Shift};
+    axes.sig = {meshArray(-0.08, 0.07, 0.01), AxisKind::Shift};
+    axes.T = {meshArray(0.0, 0.15, 0.01), AxisKind::Shift};
+    for (size_t n : sizes) {
+        n = max<size_t>(1, n / 1000); // options, not points
+        vector<vector<double>> matrix = EuropeanMatrix(n);
+        vector<ScenarioOption> options;
+        for (const vector<double>& row : matrix)
+            options.push_back(ScenarioOption{OptionParameters{row[0], row[1], row[2], row[3], row[4], row[5], Call}});
+        size_t points = n * axes.Points();
+        vector<double> lowest(n * axes.T.size() * axes.sig.size()); // one slot per line, the sink runs on the pool
+        for (size_t t = 0; t < threads.size(); t++) {
+            ScenarioGridEngine engine(simd::DetectSimdLevel(), pools[t].get());
+            bench.Run("scenario/grid_stream", points, threads[t], "point", points, [&]() {
+                engine.Compute(options, axes, [&](const ScenarioLine& line) { // lowest price of each line
+                    lowest[(line.option * axes.T.size() + line.t) * axes.sig.size() + line.v] =
+                        *min_element(line.price.begin(), line.price.end());
+                });
+                bench.Consume(lowest[0]);
+            });
+        }
+    }
+}
+
+// Book of n positions on 8 underlyings: a full revaluation, and one changed position
+static void PortfolioCases(BenchmarkRunner& bench, const vector<size_t>& sizes, const vector<size_t>& threads,
+                           vector<unique_ptr<ThreadPool>>& pools)
+{
+    for (size_t n : sizes) {
+        vector<vector<double>> matrix = EuropeanMatrix(n);
+        for (size_t t = 0; t < threads.size(); t++) {
+            Portfolio book({0.25, 0.5, 1.0, 2.0}, pools[t].get());
+            for (size_t i = 0; i < n; i++) {
+                const vector<double>& row = matrix[i];
+                book.Add(Position{"U" + to_string(i * 8 / n), OptionParameters{row[0], row[1], row[2], row[3], row[4], row[5],
+                                  i % 2 ? Put : Call}, PricingModel::European, 1.0 + double(i % 7)});
+            }
+            bench.Run("portfolio/revalue_full", n, threads[t], "position", n, [&]() {
+                for (size_t i = 0; i < n; i += Portfolio::BlockSize) // touch every block
+                    book.Update(i, book[i]);
+                book.Revalue();
+                bench.Consume(book.Total().pv);
+            });
+            Position changed = book[n / 2];
+            bench.Run("portfolio/update_one", n, threads[t], "update", 1, [&]() {
+                changed.quantity += 1.0;
+                book.Update(n / 2, changed);
+                book.Revalue();
+                bench.Consume(book.Total().pv);
+            });
+        }
+    }
+}
+
+static void NormalCases(BenchmarkRunner& bench, size_t draws)
+{
+    BoostNormal boost(1);
+    bench.Run("normal/boost_getNormal", draws, 1, "normal", draws, [&]() {
+        double sum = 0.0;
+        for (size_t i = 0; i < draws; i++) sum += boost.getNormal();
+        bench.Consume(sum);
+    });
+
+    const pair<const char*, NormalMethod> methods[] = {
+        {"normal/boost_fill", NormalMethod::Boost}, {"normal/ziggurat_fill", NormalMethod::Ziggurat},
+        {"normal/box_muller_fill", NormalMethod::BoxMuller}, {"normal/inverse_cdf_fill", NormalMethod::InverseCdf}};
+    vector<double> out(draws);
+    for (const auto& method : methods) {
+        unique_ptr<NormalGenerator> gen = createNormalGenerator(method.second, 1);
+        bench.Run(method.first, draws, 1, "normal", draws, [&]() {
+            gen->fill(out.data(), draws);
+            bench.Consume(out[0]);
+        });
+    }
+}
+
+static void MonteCarloCases(BenchmarkRunner& bench, const vector<size_t>& paths, const vector<size_t>& threads)
+{
+    OptionData data = MonteCarloData();
+    for (size_t n : paths) {
+        for (size_t t : threads) {
+            for (bool lockstep : {false, true}) {
+                MCSettings settings;
+                settings.NT = 100;
+                settings.NSim = n;
+                settings.nThreads = int(t);
+                settings.method = NormalMethod::Ziggurat;
+                settings.lockstep = lockstep;
+                MonteCarloEngine<GBM> engine(data, GBM(data), settings);
+                bench.Run(lockstep ? "mc/gbm_euler_lockstep" : "mc/gbm_euler_path", n, t, "path", n, [&]() {
+                    bench.Consume(engine.run().call.mean());
+                });
+            }
+        }
+    }
+}
+
+static void FiniteDifferenceCases(BenchmarkRunner& bench)
+{
+    OptionData data = MonteCarloData();
+    FDMEngine engine; // default 400 x 200 sinh mesh
+    bench.Run("fdm/european_put", 1, 1, "option", 1, [&]() {
+        bench.Consume(engine.price(data, ExerciseStyle::European).price);
+    });
+    bench.Run("fdm/american_put", 1, 1, "option", 1, [&]() {
+        bench.Consume(engine.price(data, ExerciseStyle::American).price);
+    });
+}
+
+int main(int argc, const char * argv[]) {
+    string filter, format = "json", outPath;
+    bool quick = false;
+    double minTime = -1.0;
+    vector<size_t> threads, sizes;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : "";
+        if (arg == "--filter") { filter = value; i++; }
+        else if (arg == "--format" && (strcmp(value, "json") == 0 || strcmp(value, "csv") == 0)) { format = value; i++; }
+        else if (arg == "--out") { outPath = value; i++; }
+        else if (arg == "--min-time") { minTime = atof(value); i++; }
+        else if (arg == "--threads") { threads = ParseList(value); i++; }
+        else if (arg == "--sizes") { sizes = ParseList(value); i++; }
+        else if (arg == "--quick") { quick = true; }
+        else {
+            fprintf(stderr, "usage: %s [--filter text] [--format json|csv] [--out file] [--quick]\n"
+                            "       [--min-time seconds] [--threads 1,2,4] [--sizes 1000,100000]\n", argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    size_t hardware = max<size_t>(1, thread::hardware_concurrency());
+    if (threads.empty()) { // powers of two up to the hardware, and the hardware itself
+        for (size_t t = 1; t < hardware; t *= 2) threads.push_back(t);
+        threads.push_back(hardware);
+    }
+    if (sizes.empty())
+        sizes = quick ? vector<size_t>{1000, 16384} : vector<size_t>{1000, 100000, 1000000};
+    vector<size_t> paths = quick ? vector<size_t>{8192} : vector<size_t>{16384, 131072};
+
+    BenchmarkRunner bench(filter);
+    bench.MinTime = minTime >= 0.0 ? minTime : quick ? 0.02 : 0.2;
+    bench.Repetitions = quick ? 1 : 3;
+
+    vector<unique_ptr<ThreadPool>> pools;
+    for (size_t t : threads)
+        pools.emplace_back(new ThreadPool(t));
+
+    EuropeanCases(bench, sizes, threads, pools);
+    PerpetualCases(bench, sizes, threads, pools);
+    ScenarioCases(bench, sizes, threads, pools);
+    PortfolioCases(bench, sizes, threads, pools);
+    NormalCases(bench, quick ? 1 << 16 : 1 << 20);
+    MonteCarloCases(bench, paths, threads);
+    FiniteDifferenceCases(bench);
+
+    FILE* out = outPath.empty() ? stdout : fopen(outPath.c_str(), "w");
+    if (out == nullptr) {
+        perror(outPath.c_str());
+        return 1;
+    }
+    if (format == "csv") {
+        bench.WriteCsv(out);
+    } else {
+        vector<pair<string, string>> context = {
+#if defined(__clang__)
+            {"compiler", "clang " __clang_version__},
+#elif defined(__GNUC__)
+            {"compiler", "gcc " __VERSION__},
+#endif
+            {"simd_level", to_string((int)simd::DetectSimdLevel())},
+            {"hardware_threads", to_string(hardware)},
+            {"min_time", to_string(bench.MinTime)},
+            {"repetitions", to_string(bench.Repetitions)}};
+        bench.WriteJson(out, context);
+    }
+    if (out != stdout)
+        fclose(out);
+    return 0;
+}
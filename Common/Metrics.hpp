@@ -0,0 +1,343 @@
+// Metrics.hpp
+//
+// Compile-time switchable instrumentation shared by the pricing engines of
+// both groups: per-engine counters (options priced, paths, time steps, RNG
+// draws, negative spot values) and scoped timers with log2 histograms for
+// the phases of a run.
+//
+// Build with PRICING_METRICS=1 to record. Otherwise every function below is
+// an empty inline and ScopedTimer an empty class, so the calls compile away
+// and the disabled build is the uninstrumented one.
+//
+// Each timed scope costs two steady_clock reads and a few relaxed atomic
+// adds. The batch pricers record per call and the FDM engine per time step.
+// The Monte Carlo engine times every path, so its scopes record into a
+// BlockTimers, plain histograms owned by the thread running the block, which
+// are added to the registry once per block: no shared cache line is touched
+// per path. Counters and histograms are global, thread-safe and reset with
+// metrics::reset(). snapshot() copies them into plain values, which text()
+// and json() format for export.
+//
+// Hanlin Yan
+// Oct 18 2026
+//
+
+#ifndef Metrics_HPP
+#define Metrics_HPP
+
+#ifndef PRICING_METRICS
+#define PRICING_METRICS 0
+#endif
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#if PRICING_METRICS
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#endif
+
+namespace metrics
+{
+
+enum class Engine { EuropeanBatch, PerpetualBatch, ImpliedVol, ScenarioGrid, MonteCarlo, FDM, Count };
+enum class Counter { OptionsPriced, Paths, TimeSteps, RngDraws, NegativeSpot, Count };
+enum class Phase { Setup, Rng, Stepping, Payoff, Reduction, Kernel, Count };
+
+constexpr bool enabled = PRICING_METRICS != 0;
+
+constexpr const char* engineNames[] = { "european_batch", "perpetual_batch", "implied_vol", "scenario_grid", "monte_carlo", "fdm" };
+constexpr const char* counterNames[] = { "options_priced", "paths", "time_steps", "rng_draws", "negative_spot" };
+constexpr const char* phaseNames[] = { "setup", "rng", "stepping", "payoff", "reduction", "kernel" };
+
+constexpr std::size_t nEngines = std::size_t(Engine::Count);
+constexpr std::size_t nCounters = std::size_t(Counter::Count);
+constexpr std::size_t nPhases = std::size_t(Phase::Count);
+constexpr std::size_t nBuckets = 40;    // bucket i holds durations in [2^i, 2^(i+1)) ns
+
+struct Histogram
+{
+    std::uint64_t count = 0;
+    std::uint64_t totalNs = 0;
+    std::uint64_t maxNs = 0;
+    std::array<std::uint64_t, nBuckets> buckets{};
+
+    double meanNs() const { return count > 0 ? double(totalNs) / double(count) : 0.0; }
+
+    double quantileNs(double q) const
+    { // Upper edge of the bucket holding the q quantile
+        std::uint64_t rank = std::uint64_t(q * double(count)), seen = 0;
+        for (std::size_t i = 0; i < nBuckets; ++i)
+        {
+            seen += buckets[i];
+            if (seen > rank)
+                return double(std::uint64_t(1) << (i + 1));
+        }
+        return double(maxNs);
+    }
+};
+
+struct Snapshot
+{
+    std::array<std::array<std::uint64_t, nCounters>, nEngines> counters{};
+    std::array<std::array<Histogram, nPhases>, nEngines> timers{};
+
+    std::string text() const;
+    std::string json() const;
+};
+
+#if PRICING_METRICS
+
+class Registry
+{
+private:
+    struct AtomicHistogram
+    {
+        std::atomic<std::uint64_t> count{0}, totalNs{0}, maxNs{0};
+        std::array<std::atomic<std::uint64_t>, nBuckets> buckets{};
+    };
+
+    std::array<std::array<std::atomic<std::uint64_t>, nCounters>, nEngines> counters{};
+    std::array<std::array<AtomicHistogram, nPhases>, nEngines> timers;
+
+public:
+    static Registry& instance()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    void add(Engine e, Counter c, std::uint64_t n)
+    {
+        counters[std::size_t(e)][std::size_t(c)].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    void merge(Engine e, Phase p, const Histogram& local)
+    { // One add per field of a histogram recorded elsewhere
+        if (local.count == 0)
+            return;
+        AtomicHistogram& h = timers[std::size_t(e)][std::size_t(p)];
+        h.count.fetch_add(local.count, std::memory_order_relaxed);
+        h.totalNs.fetch_add(local.totalNs, std::memory_order_relaxed);
+        std::uint64_t m = h.maxNs.load(std::memory_order_relaxed);
+        while (local.maxNs > m && !h.maxNs.compare_exchange_weak(m, local.maxNs, std::memory_order_relaxed))
+            ;
+        for (std::size_t i = 0; i < nBuckets; ++i)
+            if (local.buckets[i] > 0)
+                h.buckets[i].fetch_add(local.buckets[i], std::memory_order_relaxed);
+    }
+
+    void record(Engine e, Phase p, std::uint64_t ns)
+    {
+        AtomicHistogram& h = timers[std::size_t(e)][std::size_t(p)];
+        h.count.fetch_add(1, std::memory_order_relaxed);
+        h.totalNs.fetch_add(ns, std::memory_order_relaxed);
+        std::uint64_t m = h.maxNs.load(std::memory_order_relaxed);
+        while (ns > m && !h.maxNs.compare_exchange_weak(m, ns, std::memory_order_relaxed))
+            ;
+        h.buckets[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static std::size_t bucketOf(std::uint64_t ns)
+    {
+        std::size_t bucket = ns > 0 ? std::size_t(63 - __builtin_clzll(ns)) : 0;
+        return bucket < nBuckets ? bucket : nBuckets - 1;
+    }
+
+    Snapshot snapshot() const
+    {
+        Snapshot s;
+        for (std::size_t e = 0; e < nEngines; ++e)
+        {
+            for (std::size_t c = 0; c < nCounters; ++c)
+                s.counters[e][c] = counters[e][c].load(std::memory_order_relaxed);
+            for (std::size_t p = 0; p < nPhases; ++p)
+            {
+                const AtomicHistogram& a = timers[e][p];
+                Histogram& h = s.timers[e][p];
+                h.count = a.count.load(std::memory_order_relaxed);
+                h.totalNs = a.totalNs.load(std::memory_order_relaxed);
+                h.maxNs = a.maxNs.load(std::memory_order_relaxed);
+                for (std::size_t i = 0; i < nBuckets; ++i)
+                    h.buckets[i] = a.buckets[i].load(std::memory_order_relaxed);
+            }
+        }
+        return s;
+    }
+
+    void reset()
+    {
+        for (std::size_t e = 0; e < nEngines; ++e)
+        {
+            for (std::size_t c = 0; c < nCounters; ++c)
+                counters[e][c].store(0, std::memory_order_relaxed);
+            for (std::size_t p = 0; p < nPhases; ++p)
+            {
+                AtomicHistogram& h = timers[e][p];
+                h.count.store(0, std::memory_order_relaxed);
+                h.totalNs.store(0, std::memory_order_relaxed);
+                h.maxNs.store(0, std::memory_order_relaxed);
+                for (std::size_t i = 0; i < nBuckets; ++i)
+                    h.buckets[i].store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+inline void count(Engine e, Counter c, std::uint64_t n) { Registry::instance().add(e, c, n); }
+inline Snapshot snapshot() { return Registry::instance().snapshot(); }
+inline void reset() { Registry::instance().reset(); }
+
+class BlockTimers
+{ // Phase histograms of one engine owned by one thread, merged into the registry by flush() or on destruction
+private:
+    Engine engine;
+    std::array<Histogram, nPhases> local{};
+
+public:
+    explicit BlockTimers(Engine e) : engine(e) {}
+    BlockTimers(const BlockTimers&) = delete;
+    BlockTimers& operator = (const BlockTimers&) = delete;
+    ~BlockTimers() { flush(); }
+
+    void record(Phase p, std::uint64_t ns)
+    {
+        Histogram& h = local[std::size_t(p)];
+        h.count++;
+        h.totalNs += ns;
+        h.maxNs = ns > h.maxNs ? ns : h.maxNs;
+        h.buckets[Registry::bucketOf(ns)]++;
+    }
+
+    void flush()
+    {
+        for (std::size_t p = 0; p < nPhases; ++p)
+        {
+            Registry::instance().merge(engine, Phase(p), local[p]);
+            local[p] = Histogram();
+        }
+    }
+};
+
+class ScopedTimer
+{ // Records the lifetime of the scope under (engine, phase), or into a BlockTimers
+private:
+    Engine engine;
+    Phase phase;
+    BlockTimers* block;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    ScopedTimer(Engine e, Phase p) : engine(e), phase(p), block(nullptr), start(std::chrono::steady_clock::now()) {}
+    ScopedTimer(BlockTimers& b, Phase p) : engine(), phase(p), block(&b), start(std::chrono::steady_clock::now()) {}
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator = (const ScopedTimer&) = delete;
+
+    ~ScopedTimer()
+    {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        std::uint64_t ns = std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        if (block != nullptr)
+            block->record(phase, ns);
+        else
+            Registry::instance().record(engine, phase, ns);
+    }
+};
+
+inline std::string Snapshot::text() const
+{
+    std::string out;
+    char line[256];
+    for (std::size_t e = 0; e < nEngines; ++e)
+    {
+        bool used = false;
+        for (std::size_t c = 0; c < nCounters; ++c)
+            used = used || counters[e][c] > 0;
+        for (std::size_t p = 0; p < nPhases; ++p)
+            used = used || timers[e][p].count > 0;
+        if (!used)
+            continue;
+
+        out += engineNames[e];
+        out += "\n";
+        for (std::size_t c = 0; c < nCounters; ++c)
+            if (counters[e][c] > 0)
+            {
+                std::snprintf(line, sizeof(line), "  %-16s %llu\n", counterNames[c], (unsigned long long)counters[e][c]);
+                out += line;
+            }
+        for (std::size_t p = 0; p < nPhases; ++p)
+        {
+            const Histogram& h = timers[e][p];
+            if (h.count == 0)
+                continue;
+            std::snprintf(line, sizeof(line), "  %-16s n %llu  total %.3f ms  mean %.0f ns  p50 < %.0f ns  p99 < %.0f ns  max %llu ns\n",
+                phaseNames[p], (unsigned long long)h.count, 1e-6 * double(h.totalNs), h.meanNs(),
+                h.quantileNs(0.5), h.quantileNs(0.99), (unsigned long long)h.maxNs);
+            out += line;
+        }
+    }
+    return out;
+}
+
+inline std::string Snapshot::json() const
+{
+    std::string out = "{";
+    char field[128];
+    for (std::size_t e = 0; e < nEngines; ++e)
+    {
+        out += e > 0 ? ",\n " : "\n ";
+        out += "\"" + std::string(engineNames[e]) + "\": {\"counters\": {";
+        for (std::size_t c = 0; c < nCounters; ++c)
+        {
+            std::snprintf(field, sizeof(field), "%s\"%s\": %llu", c > 0 ? ", " : "", counterNames[c],
+                (unsigned long long)counters[e][c]);
+            out += field;
+        }
+        out += "}, \"timers\": {";
+        for (std::size_t p = 0; p < nPhases; ++p)
+        {
+            const Histogram& h = timers[e][p];
+            std::snprintf(field, sizeof(field), "%s\"%s\": {\"count\": %llu, \"total_ns\": %llu, \"max_ns\": %llu, \"buckets\": [",
+                p > 0 ? ", " : "", phaseNames[p], (unsigned long long)h.count, (unsigned long long)h.totalNs,
+                (unsigned long long)h.maxNs);
+            out += field;
+            for (std::size_t i = 0; i < nBuckets; ++i)
+                out += (i > 0 ? "," : "") + std::to_string(h.buckets[i]);
+            out += "]}";
+        }
+        out += "}}";
+    }
+    return out + "\n}\n";
+}
+
+#else
+
+inline void count(Engine, Counter, std::uint64_t) {}
+inline Snapshot snapshot() { return Snapshot(); }
+inline void reset() {}
+
+class BlockTimers
+{
+public:
+    explicit BlockTimers(Engine) {}
+    void flush() {}
+};
+
+class ScopedTimer
+{
+public:
+    ScopedTimer(Engine, Phase) {}
+    ScopedTimer(BlockTimers&, Phase) {}
+};
+
+inline std::string Snapshot::text() const { return std::string(); }
+inline std::string Snapshot::json() const { return std::string("{}\n"); }
+
+#endif
+
+}
+
+#endif
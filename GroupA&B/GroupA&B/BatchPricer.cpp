@@ -0,0 +1,189 @@
+//
+//  BatchPricer.cpp
+//  GroupA&B
+//  Structure-of-arrays batch pricer implementation
+//  Created by Kevin on 10/18/26.
+//
+
+#include "BatchPricer.hpp"
+#include "Metrics.hpp"
+#include <cmath>
+#include <stdexcept>
+#include <boost/math/distributions/normal.hpp>
+
+using namespace boost::math;
+using namespace simd;
+
+// Kernels are instantiated for Omega = Call, Put, or 0 for a mixed batch that reads the type column
+
+// Scalar reference path: price, delta and gamma of row i from one set of intermediates
+template <int Omega>
+static void ComputeRow(const EuropeanBatch& in, const BatchResult& out, size_t i)
+{
+    double T = in.T[i], K = in.K[i], sig = in.sig[i], r = in.r[i], b = in.b[i], S = in.S[i];
+    double w = Omega != 0 ? Omega : in.type[i]; // +1 call, -1 put
+
+    double tmp = sig * sqrt(T);
+    double d1 = ( log(S/K) + (b+ (sig*sig)*0.5 ) * T )/ tmp;
+    double d2 = d1 - tmp;
+    double carry = exp((b-r)*T);
+
+    normal_distribution<> normalDist(0, 1);
+    double Nd1 = cdf(normalDist, w * d1);
+
+    if (!out.price.empty())
+        out.price[i] = w * ((S * carry * Nd1) - (K * exp(-r * T) * cdf(normalDist, w * d2)));
+    if (!out.delta.empty())
+        out.delta[i] = w * carry * Nd1;
+    if (!out.gamma.empty())
+        out.gamma[i] = pdf(normalDist, d1) * carry / (S * tmp);
+}
+
+// Rows [i, i + count) with one vector of W lanes, count <= W. Partial blocks are padded.
+template <class V, class Ops, int Omega>
+SIMD_INLINE void ComputeBlock(const EuropeanBatch& in, const BatchResult& out, size_t i, size_t count)
+{
+    const int W = Lanes<V>();
+    V T, K, sig, r, b, S, w;
+    if (count == (size_t)W) {
+        T = Load<V>(&in.T[i]); K = Load<V>(&in.K[i]); sig = Load<V>(&in.sig[i]);
+        r = Load<V>(&in.r[i]); b = Load<V>(&in.b[i]); S = Load<V>(&in.S[i]);
+    } else {
+        T = K = sig = S = Broadcast<V>(1.0); r = b = V{};
+        for (size_t j = 0; j < count; j++) {
+            T[j] = in.T[i + j]; K[j] = in.K[i + j]; sig[j] = in.sig[i + j];
+            r[j] = in.r[i + j]; b[j] = in.b[i + j]; S[j] = in.S[i + j];
+        }
+    }
+    w = Broadcast<V>(Omega != 0 ? Omega : 1.0);
+    if (Omega == 0)
+        for (size_t j = 0; j < count; j++)
+            w[j] = in.type[i + j];
+
+    V tmp = sig * Ops::Sqrt(T);
+    V d1 = (Log(S / K) + (b + (sig * sig) * 0.5) * T) / tmp;
+    V carry = Exp((b - r) * T);
+    V pdf;
+    V Nd1 = NormalCdf(w * d1, pdf);
+
+    V price{}, delta{}, gamma{};
+    if (!out.price.empty())
+        price = w * ((S * carry * Nd1) - (K * Exp(-r * T) * NormalCdf(w * (d1 - tmp))));
+    if (!out.delta.empty())
+        delta = w * carry * Nd1;
+    if (!out.gamma.empty())
+        gamma = pdf * carry / (S * tmp);
+
+    for (size_t j = 0; j < count; j++) { // the compiler turns full blocks into vector stores
+        if (!out.price.empty()) out.price[i + j] = price[j];
+        if (!out.delta.empty()) out.delta[i + j] = delta[j];
+        if (!out.gamma.empty()) out.gamma[i + j] = gamma[j];
+    }
+}
+
+template <class V, class Ops, int Omega>
+SIMD_INLINE void ComputeVector(const EuropeanBatch& in, const BatchResult& out, size_t begin, size_t end)
+{
+    const size_t W = Lanes<V>();
+    size_t i = begin;
+    for (; i + W <= end; i += W)
+        ComputeBlock<V, Ops, Omega>(in, out, i, W);
+    if (i < end)
+        ComputeBlock<V, Ops, Omega>(in, out, i, end - i);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+template <int Omega> __attribute__((target("avx512f")))
+static void ComputeAvx512(const EuropeanBatch& in, const BatchResult& out, size_t begin, size_t end)
+{
+    ComputeVector<vd8, Avx512Ops, Omega>(in, out, begin, end);
+}
+
+template <int Omega> __attribute__((target("avx2,fma")))
+static void ComputeAvx2(const EuropeanBatch& in, const BatchResult& out, size_t begin, size_t end)
+{
+    ComputeVector<vd4, Avx2Ops, Omega>(in, out, begin, end);
+}
+
+template <int Omega> __attribute__((target("sse2")))
+static void Compute128(const EuropeanBatch& in, const BatchResult& out, size_t begin, size_t end)
+{
+    ComputeVector<vd2, Sse2Ops, Omega>(in, out, begin, end);
+}
+#else
+template <int Omega>
+static void Compute128(const EuropeanBatch& in, const BatchResult& out, size_t begin, size_t end)
+{
+    ComputeVector<vd2, GenericOps, Omega>(in, out, begin, end);
+}
+#endif
+
+template <int Omega>
+static void ComputeRange(SimdLevel level, const EuropeanBatch& in, const BatchResult& out, size_t begin, size_t end)
+{
+    switch (level) {
+#if defined(__x86_64__) || defined(__i386__)
+    case SimdLevel::Simd512: ComputeAvx512<Omega>(in, out, begin, end); break;
+    case SimdLevel::Simd256: ComputeAvx2<Omega>(in, out, begin, end); break;
+#endif
+    case SimdLevel::Simd128: Compute128<Omega>(in, out, begin, end); break;
+    default:
+        for (size_t i = begin; i < end; i++)
+            ComputeRow<Omega>(in, out, i);
+    }
+}
+
+EuropeanBatchPricer::EuropeanBatchPricer(): level(DetectSimdLevel()), pool(&ThreadPool::Shared()) {}
+
+EuropeanBatchPricer::EuropeanBatchPricer(SimdLevel level_, ThreadPool* pool_): level(min(level_, DetectSimdLevel())), pool(pool_) {}
+
+void EuropeanBatchPricer::Compute(const EuropeanBatch& in, const BatchResult& out) const
+{
+    size_t n = in.size();
+    metrics::ScopedTimer timer(metrics::Engine::EuropeanBatch, metrics::Phase::Kernel);
+    metrics::count(metrics::Engine::EuropeanBatch, metrics::Counter::OptionsPriced, n);
+    if (n < 8 && level != SimdLevel::Scalar) { // shorter than one vector
+        EuropeanBatchPricer(SimdLevel::Scalar, nullptr).Compute(in, out, 0, n);
+    } else if (pool == nullptr || n < ParallelThreshold) {
+        Compute(in, out, 0, n);
+    } else {
+        pool->ParallelFor(n, ChunkSize, [&](size_t begin, size_t end) { Compute(in, out, begin, end); });
+    }
+}
+
+void EuropeanBatchPricer::Compute(const EuropeanBatch& in, const BatchResult& out, size_t begin, size_t end) const
+{
+    size_t n = in.size();
+    if (in.T.size() != n || in.K.size() != n || in.sig.size() != n || in.r.size() != n
+        || in.b.size() != n || (!in.type.empty() && in.type.size() != n))
+        throw invalid_argument("EuropeanBatchPricer: input columns differ in length");
+    if ((!out.price.empty() && out.price.size() != n) || (!out.delta.empty() && out.delta.size() != n)
+        || (!out.gamma.empty() && out.gamma.size() != n))
+        throw invalid_argument("EuropeanBatchPricer: output column does not match batch size");
+    if (begin > end || end > n)
+        throw out_of_range("EuropeanBatchPricer: row range outside the batch");
+
+    if (!in.type.empty())
+        ComputeRange<0>(level, in, out, begin, end);
+    else if (in.allType == Call)
+        ComputeRange<Call>(level, in, out, begin, end);
+    else
+        ComputeRange<Put>(level, in, out, begin, end);
+}
+
+EuropeanColumns::EuropeanColumns(const vector<vector<double>>& parameter_matrix, OptionType opt_type)
+    : data(6 * parameter_matrix.size()), type(opt_type), n(parameter_matrix.size())
+{ // transpose once, rows are read by reference
+    for (size_t i = 0; i < n; i++) {
+        const vector<double>& row = parameter_matrix[i];
+        for (size_t j = 0; j < 6; j++)
+            data[j * n + i] = row[j];
+    }
+}
+
+EuropeanBatch EuropeanColumns::Batch() const
+{
+    span<const double> all(data);
+    return EuropeanBatch{ all.subspan(0, n), all.subspan(n, n), all.subspan(2 * n, n),
+                          all.subspan(3 * n, n), all.subspan(4 * n, n), all.subspan(5 * n, n), {}, type };
+}
@@ -0,0 +1,75 @@
+//
+//  BatchPricer.hpp
+//  GroupA&B
+//  Structure-of-arrays batch pricer for European options
+//  Created by Kevin on 10/18/26.
+//
+
+#ifndef BatchPricer_hpp
+#define BatchPricer_hpp
+
+#include <span>
+#include <vector>
+#include "SimdMath.hpp"
+#include "ThreadPool.hpp"
+#include "Option.hpp"
+
+using namespace std;
+
+// Contiguous input columns, one entry per option. All columns have the same length.
+struct EuropeanBatch {
+    span<const double> T;   // expiry time/maturity
+    span<const double> K;   // strike price
+    span<const double> sig; // volatility
+    span<const double> r;   // risk-free interest rate
+    span<const double> b;   // cost of carry
+    span<const double> S;   // asset price
+    span<const OptionType> type; // per-row type, empty for a homogeneous batch
+    OptionType allType = Call;    // type of every row when the type column is empty
+
+    size_t size() const { return S.size(); }
+};
+
+// Caller-owned output columns. An empty span means "do not compute".
+struct BatchResult {
+    span<double> price;
+    span<double> delta;
+    span<double> gamma;
+};
+
+// Homogeneous batches run kernels instantiated for Call or Put, mixed batches a
+// branch-free kernel that multiplies by the type sign. Execution is chosen from the batch size: batches shorter than one vector run the
+// scalar kernel, up to ParallelThreshold rows the SIMD kernel runs on the calling
+// thread, larger batches are split into ChunkSize row ranges over the thread pool.
+// Every row is computed independently, so results do not depend on the thread count.
+class EuropeanBatchPricer {
+private:
+    simd::SimdLevel level; // kernel used by Compute
+    ThreadPool* pool;      // nullptr keeps everything on the calling thread
+
+public:
+    static const size_t ParallelThreshold = 16384;
+    static const size_t ChunkSize = 4096;
+
+    EuropeanBatchPricer(); // widest kernel the cpu supports, shared thread pool
+    EuropeanBatchPricer(simd::SimdLevel level, ThreadPool* pool = &ThreadPool::Shared()); // level capped at what the cpu supports
+
+    simd::SimdLevel Level() const { return level; }
+
+    // Price every row of the batch and write the requested outputs, no per-row allocation
+    void Compute(const EuropeanBatch& batch, const BatchResult& result) const;
+    // Rows [begin, end) only, on the calling thread
+    void Compute(const EuropeanBatch& batch, const BatchResult& result, size_t begin, size_t end) const;
+};
+
+// Column buffer for a row-major parameter matrix {T, K, sig, r, b, S}
+struct EuropeanColumns {
+    vector<double> data; // 6 contiguous columns of n rows
+    OptionType type;
+    size_t n = 0;
+
+    EuropeanColumns(const vector<vector<double>>& parameter_matrix, OptionType opt_type);
+    EuropeanBatch Batch() const;
+};
+
+#endif /* BatchPricer_hpp */
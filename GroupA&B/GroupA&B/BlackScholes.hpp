@@ -0,0 +1,105 @@
+//
+//  BlackScholes.hpp
+//  GroupA&B
+//  Generalised Black-Scholes kernels specialised on the option type
+//  Created by Kevin on 10/18/26.
+//
+
+#ifndef BlackScholes_hpp
+#define BlackScholes_hpp
+
+#include <cmath>
+#include <boost/math/distributions/normal.hpp>
+#include "Option.hpp"
+
+// With w = +1 for calls and -1 for puts:
+//   price = w * (S e^{(b-r)T} N(w d1) - K e^{-rT} N(w d2))
+// The type is a template parameter, so w folds away at compile time.
+
+template <OptionType type>
+inline double BlackScholesPrice(double T, double K, double sig, double r, double b, double S)
+{
+    double tmp = sig * std::sqrt(T);
+    
+    double d1 = ( std::log(S/K) + (b+ (sig*sig)*0.5 ) * T )/ tmp;
+    double d2 = d1 - tmp;
+    
+    boost::math::normal_distribution<> normalDist(0, 1);
+    const double w = type; // +1 call, -1 put
+    
+    return w * ((S * std::exp((b-r)*T) * cdf(normalDist, w * d1)) - (K * std::exp(-r * T) * cdf(normalDist, w * d2)));
+}
+
+template <OptionType type>
+inline double BlackScholesDelta(double T, double K, double sig, double r, double b, double S)
+{
+    double tmp = sig * std::sqrt(T);
+    
+    double d1 = ( std::log(S/K) + (b+ (sig*sig)*0.5 ) * T )/ tmp;
+    
+    boost::math::normal_distribution<> normalDist(0, 1);
+    
+    if constexpr (type == Call)
+        return std::exp((b-r)*T) * cdf(normalDist, d1);
+    else
+        return std::exp((b-r)*T) * (cdf(normalDist, d1) - 1.0);
+}
+
+inline double BlackScholesGamma(double T, double K, double sig, double r, double b, double S)
+{
+    double tmp = sig * std::sqrt(T);
+    
+    double d1 = ( std::log(S/K) + (b+ (sig*sig)*0.5 ) * T )/ tmp;
+    
+    boost::math::normal_distribution<> normalDist(0, 1);
+    
+    return pdf(normalDist, d1) * std::exp((b-r)*T) /(S * sig * std::sqrt(T));
+}
+
+// The intermediates that do not depend on S. With them at hand a price costs
+// one log and two cdfs:  d1 = (log S - log K + drift) / vol,  d2 = d1 - vol
+struct BlackScholesInvariants {
+    double sqrtT = 0.0; // sqrt(T)
+    double vol = 0.0;   // sig sqrt(T)
+    double drift = 0.0; // (b + sig^2/2) T
+    double carry = 0.0; // e^{(b-r)T}
+    double df = 0.0;    // e^{-rT}
+    double logK = 0.0;  // log K
+};
+
+inline double BlackScholesD1(const BlackScholesInvariants& inv, double S)
+{
+    return (std::log(S) - inv.logK + inv.drift) / inv.vol;
+}
+
+template <OptionType type>
+inline double BlackScholesPrice(const BlackScholesInvariants& inv, double K, double S)
+{
+    double d1 = BlackScholesD1(inv, S);
+    double d2 = d1 - inv.vol;
+    
+    boost::math::normal_distribution<> normalDist(0, 1);
+    const double w = type; // +1 call, -1 put
+    
+    return w * ((S * inv.carry * cdf(normalDist, w * d1)) - (K * inv.df * cdf(normalDist, w * d2)));
+}
+
+template <OptionType type>
+inline double BlackScholesDelta(const BlackScholesInvariants& inv, double S)
+{
+    boost::math::normal_distribution<> normalDist(0, 1);
+    
+    if constexpr (type == Call)
+        return inv.carry * cdf(normalDist, BlackScholesD1(inv, S));
+    else
+        return inv.carry * (cdf(normalDist, BlackScholesD1(inv, S)) - 1.0);
+}
+
+inline double BlackScholesGamma(const BlackScholesInvariants& inv, double S)
+{
+    boost::math::normal_distribution<> normalDist(0, 1);
+    
+    return pdf(normalDist, BlackScholesD1(inv, S)) * inv.carry / (S * inv.vol);
+}
+
+#endif /* BlackScholes_hpp */
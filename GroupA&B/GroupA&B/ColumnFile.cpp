@@ -0,0 +1,395 @@
+//
+//  ColumnFile.cpp
+//  GroupA&B
+//  Memory-mapped columnar files for parameter and result batches, CSV interop
+//  Created by Kevin on 10/18/26.
+//
+
+#include "ColumnFile.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char Magic[8] = "OPTCOLS";
+static const uint32_t Version = 1;
+static const size_t ParameterColumns = 6; // T, K, sig, r, b, S; the type column follows
+static const size_t ResultColumns = 3;    // price, delta, gamma
+static const size_t BufferSize = 1 << 20;
+
+static size_t AlignUp(size_t bytes) { return (bytes + ColumnFileHeader::Alignment - 1) & ~(ColumnFileHeader::Alignment - 1); }
+
+static runtime_error FileError(const char* what, const string& path)
+{
+    return runtime_error(string(what) + " " + path + ": " + strerror(errno));
+}
+
+// Header of a file with the given column widths in bytes, returns the file size
+static size_t Layout(ColumnFileHeader& header, ColumnFileKind kind, size_t rows, const size_t* widths, size_t columns)
+{
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.kind = kind;
+    header.rows = rows;
+    size_t at = sizeof(ColumnFileHeader);
+    for (size_t j = 0; j < columns; j++) {
+        header.offset[j] = at;
+        at = AlignUp(at + rows * widths[j]);
+    }
+    return at;
+}
+
+// Header of a mapped file, checked against its kind and size
+static const ColumnFileHeader* Validate(const MappedFile& file, ColumnFileKind kind, const string& path)
+{
+    if (file.Size() < sizeof(ColumnFileHeader))
+        throw runtime_error("ColumnFile: " + path + " is too short for a header");
+    const ColumnFileHeader* header = (const ColumnFileHeader*)file.Data();
+    if (memcmp(header->magic, Magic, sizeof(Magic)) != 0 || header->version != Version || header->kind != kind)
+        throw runtime_error("ColumnFile: " + path + " is not a column file of the expected kind");
+    for (size_t j = 0; j < ColumnFileHeader::MaxColumns; j++) {
+        size_t width = kind == ColumnFileKind::Parameters && j == ParameterColumns ? sizeof(OptionType) : sizeof(double);
+        if (header->offset[j] != 0 && (header->offset[j] % ColumnFileHeader::Alignment != 0
+            || header->offset[j] > file.Size() || header->rows > (file.Size() - header->offset[j]) / width))
+            throw runtime_error("ColumnFile: " + path + " is truncated");
+    }
+    return header;
+}
+
+template <class T>
+static span<T> Column(const MappedFile& file, const ColumnFileHeader* header, size_t j)
+{
+    if (header->offset[j] == 0)
+        return {};
+    return span<T>((T*)(file.Data() + header->offset[j]), header->rows);
+}
+
+void MappedFile::Close()
+{
+    if (base != nullptr)
+        munmap(base, length);
+    if (fd >= 0)
+        close(fd);
+    base = nullptr;
+    fd = -1;
+    length = 0;
+}
+
+MappedFile::MappedFile(const string& path)
+{
+    fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw FileError("MappedFile: cannot open", path);
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        Close();
+        throw FileError("MappedFile: cannot stat", path);
+    }
+    length = info.st_size;
+    if (length > 0) {
+        void* p = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            Close();
+            throw FileError("MappedFile: cannot map", path);
+        }
+        base = (char*)p;
+        madvise(base, length, MADV_SEQUENTIAL); // the pricers stream through the columns
+    }
+}
+
+MappedFile::MappedFile(const string& path, size_t bytes)
+{
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        throw FileError("MappedFile: cannot create", path);
+    if (ftruncate(fd, bytes) != 0) {
+        Close();
+        throw FileError("MappedFile: cannot resize", path);
+    }
+    length = bytes;
+    void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        Close();
+        throw FileError("MappedFile: cannot map", path);
+    }
+    base = (char*)p;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept: fd(other.fd), base(other.base), length(other.length)
+{
+    other.fd = -1;
+    other.base = nullptr;
+    other.length = 0;
+}
+
+MappedFile& MappedFile::operator = (MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        Close();
+        swap(fd, other.fd);
+        swap(base, other.base);
+        swap(length, other.length);
+    }
+    return *this;
+}
+
+ParameterFile::ParameterFile(const string& path): file(path), header(Validate(file, ColumnFileKind::Parameters, path))
+{ // the type column is read as OptionType, any other value would price as neither call nor put
+    for (OptionType type : Column<const OptionType>(file, header, ParameterColumns))
+        if (type != Call && type != Put)
+            throw runtime_error("ColumnFile: " + path + " has an option type other than 1 or -1");
+}
+
+EuropeanBatch ParameterFile::Batch() const
+{
+    EuropeanBatch batch;
+    batch.T = Column<const double>(file, header, 0);
+    batch.K = Column<const double>(file, header, 1);
+    batch.sig = Column<const double>(file, header, 2);
+    batch.r = Column<const double>(file, header, 3);
+    batch.b = Column<const double>(file, header, 4);
+    batch.S = Column<const double>(file, header, 5);
+    batch.type = Column<const OptionType>(file, header, ParameterColumns);
+    batch.allType = header->allType == Put ? Put : Call;
+    return batch;
+}
+
+void ParameterFile::Write(const string& path, const EuropeanBatch& batch)
+{
+    size_t n = batch.size();
+    if (batch.T.size() != n || batch.K.size() != n || batch.sig.size() != n || batch.r.size() != n
+        || batch.b.size() != n || (!batch.type.empty() && batch.type.size() != n))
+        throw invalid_argument("ParameterFile: input columns differ in length");
+
+    const size_t widths[] = {8, 8, 8, 8, 8, 8, sizeof(OptionType)};
+    ColumnFileHeader header;
+    size_t bytes = Layout(header, ColumnFileKind::Parameters, n, widths, ParameterColumns + !batch.type.empty());
+    header.allType = batch.allType;
+
+    MappedFile file(path, bytes);
+    memcpy(file.Data(), &header, sizeof(header));
+    const span<const double> columns[] = {batch.T, batch.K, batch.sig, batch.r, batch.b, batch.S};
+    for (size_t j = 0; j < ParameterColumns; j++)
+        memcpy(file.Data() + header.offset[j], columns[j].data(), n * sizeof(double));
+    if (!batch.type.empty())
+        memcpy(file.Data() + header.offset[ParameterColumns], batch.type.data(), n * sizeof(OptionType));
+}
+
+ResultFile::ResultFile(MappedFile&& mapped, bool writable_): file(std::move(mapped)), header((const ColumnFileHeader*)file.Data()), writable(writable_) {}
+
+ResultFile::ResultFile(const string& path): file(path), header(Validate(file, ColumnFileKind::Results, path)), writable(false) {}
+
+ResultFile ResultFile::Create(const string& path, size_t rows)
+{
+    const size_t widths[] = {8, 8, 8};
+    ColumnFileHeader header;
+    size_t bytes = Layout(header, ColumnFileKind::Results, rows, widths, ResultColumns);
+    MappedFile file(path, bytes);
+    memcpy(file.Data(), &header, sizeof(header));
+    return ResultFile(std::move(file), true);
+}
+
+BatchResult ResultFile::Result() const
+{
+    if (!writable)
+        throw logic_error("ResultFile: file is mapped read-only");
+    return BatchResult{ Column<double>(file, header, 0), Column<double>(file, header, 1), Column<double>(file, header, 2) };
+}
+
+span<const double> ResultFile::Price() const { return Column<const double>(file, header, 0); }
+span<const double> ResultFile::Delta() const { return Column<const double>(file, header, 1); }
+span<const double> ResultFile::Gamma() const { return Column<const double>(file, header, 2); }
+
+// Calls line(begin, end) for every non-empty line of the file, '\r' stripped, reading BufferSize blocks
+template <class F>
+static void ForEachLine(const string& path, F line)
+{
+    unique_ptr<FILE, int (*)(FILE*)> in(fopen(path.c_str(), "rb"), fclose);
+    if (!in)
+        throw FileError("ImportCsv: cannot open", path);
+    vector<char> buffer(BufferSize);
+    size_t kept = 0; // start of a line carried over from the previous block
+    for (;;) {
+        size_t got = fread(buffer.data() + kept, 1, buffer.size() - kept, in.get());
+        size_t filled = kept + got;
+        bool last = got == 0;
+        const char* p = buffer.data();
+        const char* end = p + filled;
+        for (;;) {
+            const char* eol = (const char*)memchr(p, '\n', end - p);
+            if (eol == nullptr) {
+                if (!last)
+                    break;
+                eol = end; // last line without a newline
+            }
+            const char* stop = eol;
+            if (stop > p && stop[-1] == '\r')
+                stop--;
+            if (stop > p)
+                line(p, stop);
+            p = eol + (eol < end);
+            if (p >= end)
+                break;
+        }
+        if (last)
+            return;
+        kept = end - p;
+        if (kept == buffer.size())
+            buffer.resize(2 * buffer.size()); // a line longer than the buffer, already at the front
+        else
+            memmove(buffer.data(), p, kept);
+    }
+}
+
+static const char* FieldEnd(const char* p, const char* end)
+{ // end of the comma-separated field starting at p
+    const char* comma = (const char*)memchr(p, ',', end - p);
+    return comma ? comma : end;
+}
+
+static string Trim(const char* p, const char* end)
+{
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    while (end > p && (end[-1] == ' ' || end[-1] == '\t')) end--;
+    return string(p, end);
+}
+
+void ImportCsv(const string& csvPath, const string& columnPath, OptionType defaultType)
+{
+    // first pass: the header names the columns, then count the rows
+    static const char* Names[] = {"T", "K", "sig", "r", "b", "S", "type"};
+    vector<int> target; // file column of each csv field, -1 ignored
+    bool named = false;
+    size_t rows = 0;
+    ForEachLine(csvPath, [&](const char* line, const char* end) {
+        if (named) {
+            rows++;
+            return;
+        }
+        for (const char* p = line; p <= end; p = FieldEnd(p, end) + 1) {
+            string name = Trim(p, FieldEnd(p, end));
+            int j = -1;
+            for (int k = 0; k <= (int)ParameterColumns; k++)
+                if (name == Names[k])
+                    j = k;
+            target.push_back(j);
+        }
+        named = true;
+    });
+    for (size_t k = 0; k < ParameterColumns; k++)
+        if (find(target.begin(), target.end(), (int)k) == target.end())
+            throw runtime_error("ImportCsv: " + csvPath + " has no column " + Names[k]);
+    bool hasType = find(target.begin(), target.end(), (int)ParameterColumns) != target.end();
+
+    const size_t widths[] = {8, 8, 8, 8, 8, 8, sizeof(OptionType)};
+    ColumnFileHeader header;
+    size_t bytes = Layout(header, ColumnFileKind::Parameters, rows, widths, ParameterColumns + hasType);
+    header.allType = defaultType;
+    MappedFile file(columnPath, bytes);
+    memcpy(file.Data(), &header, sizeof(header));
+    double* column[ParameterColumns];
+    for (size_t j = 0; j < ParameterColumns; j++)
+        column[j] = (double*)(file.Data() + header.offset[j]);
+    OptionType* type = hasType ? (OptionType*)(file.Data() + header.offset[ParameterColumns]) : nullptr;
+
+    // second pass: parse straight into the mapping, a partial file is removed on error
+    size_t lineNo = 0, row = 0;
+    try {
+        ForEachLine(csvPath, [&](const char* line, const char* end) {
+            if (lineNo++ == 0)
+                return;
+            if (row == rows)
+                throw runtime_error("ImportCsv: " + csvPath + " changed while importing");
+            const char* p = line;
+            for (size_t k = 0; k < target.size(); k++, p = FieldEnd(p, end) + 1) {
+                if (p > end)
+                    throw runtime_error("ImportCsv: missing fields on line " + to_string(lineNo));
+                const char* stop = FieldEnd(p, end);
+                while (p < stop && *p == ' ') p++;
+                int j = target[k];
+                if (j == (int)ParameterColumns) {
+                    char c = p < stop ? *p : 0;
+                    if (c == 'C' || c == 'c' || c == '1' || c == '+')
+                        type[row] = Call;
+                    else if (c == 'P' || c == 'p' || c == '-')
+                        type[row] = Put;
+                    else
+                        throw runtime_error("ImportCsv: bad option type on line " + to_string(lineNo));
+                } else if (j >= 0) {
+                    if (from_chars(p, stop, column[j][row]).ec != errc())
+                        throw runtime_error("ImportCsv: bad number in column " + string(Names[j]) + " on line " + to_string(lineNo));
+                }
+            }
+            row++;
+        });
+        if (row != rows)
+            throw runtime_error("ImportCsv: " + csvPath + " changed while importing");
+    } catch (...) {
+        unlink(columnPath.c_str());
+        throw;
+    }
+}
+
+void ExportCsv(const string& csvPath, const EuropeanBatch& batch, span<const double> price,
+               span<const double> delta, span<const double> gamma)
+{
+    size_t n = batch.size();
+    const span<const double> columns[] = {batch.T, batch.K, batch.sig, batch.r, batch.b, batch.S, price, delta, gamma};
+    static const char* Names[] = {"T", "K", "sig", "r", "b", "S", "price", "delta", "gamma"};
+    for (size_t j = 0; j < 9; j++)
+        if ((j < ParameterColumns || !columns[j].empty()) && columns[j].size() != n)
+            throw invalid_argument("ExportCsv: columns differ in length");
+    if (!batch.type.empty() && batch.type.size() != n)
+        throw invalid_argument("ExportCsv: columns differ in length");
+
+    unique_ptr<FILE, int (*)(FILE*)> out(fopen(csvPath.c_str(), "wb"), fclose);
+    if (!out)
+        throw FileError("ExportCsv: cannot create", csvPath);
+    vector<char> buffer(BufferSize);
+    size_t used = 0;
+    auto flush = [&]() {
+        if (fwrite(buffer.data(), 1, used, out.get()) != used)
+            throw FileError("ExportCsv: cannot write", csvPath);
+        used = 0;
+    };
+    auto put = [&](const char* s, size_t len) {
+        memcpy(buffer.data() + used, s, len);
+        used += len;
+    };
+
+    for (size_t j = 0; j < 9; j++) {
+        if (!columns[j].empty()) {
+            put(Names[j], strlen(Names[j]));
+            put(",", 1);
+        }
+        if (j == ParameterColumns - 1)
+            put("type,", 5);
+    }
+    buffer[used - 1] = '\n';
+
+    for (size_t i = 0; i < n; i++) {
+        if (buffer.size() - used < 512) // room for one row of shortest doubles
+            flush();
+        for (size_t j = 0; j < 9; j++) {
+            if (!columns[j].empty()) {
+                char* p = buffer.data() + used;
+                used = to_chars(p, p + 32, columns[j][i]).ptr - buffer.data();
+                buffer[used++] = ',';
+            }
+            if (j == ParameterColumns - 1) {
+                OptionType type = batch.type.empty() ? batch.allType : batch.type[i];
+                put(type == Call ? "C," : "P,", 2);
+            }
+        }
+        buffer[used - 1] = '\n';
+    }
+    flush();
+}
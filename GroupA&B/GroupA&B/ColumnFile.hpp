@@ -0,0 +1,112 @@
+//
+//  ColumnFile.hpp
+//  GroupA&B
+//  Memory-mapped columnar files for parameter and result batches, CSV interop
+//  Created by Kevin on 10/18/26.
+//
+//  Layout: a 128-byte header followed by the columns, each starting on a
+//  64-byte boundary, native byte order.
+//      parameters: T, K, sig, r, b, S as double, then type as int32 (optional)
+//      results:    price, delta, gamma as double
+//  The header stores the row count and the byte offset of every column, so a
+//  mapped file is handed to the batch pricers as spans without a copy, and a
+//  result file created with the row count is written by the pricer in place.
+//
+//  The CSV side streams through fixed buffers: the importer counts the rows,
+//  sizes the column file and parses straight into the mapping, the exporter
+//  formats with to_chars into a buffer that is flushed in large writes.
+//
+
+#ifndef ColumnFile_hpp
+#define ColumnFile_hpp
+
+#include <cstdint>
+#include <string>
+#include "BatchPricer.hpp"
+
+using namespace std;
+
+enum class ColumnFileKind : uint32_t { Parameters = 1, Results = 2 };
+
+struct ColumnFileHeader {
+    static const size_t MaxColumns = 8;
+    static const size_t Alignment = 64;
+
+    char magic[8];              // "OPTCOLS" and a terminating zero
+    uint32_t version;
+    ColumnFileKind kind;
+    uint64_t rows;
+    uint64_t offset[MaxColumns]; // byte offset of each column from the start of the file, 0 when absent
+    int32_t allType;             // type of every row when there is no type column
+    uint8_t reserved[36];
+};
+static_assert(sizeof(ColumnFileHeader) == 128, "ColumnFileHeader must stay 128 bytes");
+
+// Read-only or read-write mapping of a whole file, unmapped on destruction
+class MappedFile {
+private:
+    int fd = -1;
+    char* base = nullptr;
+    size_t length = 0;
+
+    void Close();
+
+public:
+    MappedFile() {}
+    MappedFile(const string& path);               // map an existing file read-only
+    MappedFile(const string& path, size_t bytes); // create or truncate to bytes, map read-write
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator = (const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator = (MappedFile&& other) noexcept;
+    ~MappedFile() { Close(); }
+
+    char* Data() const { return base; }
+    size_t Size() const { return length; }
+};
+
+// Parameter columns {T, K, sig, r, b, S, type} of a mapped file
+class ParameterFile {
+private:
+    MappedFile file;
+    const ColumnFileHeader* header;
+
+public:
+    ParameterFile(const string& path); // throws runtime_error on a missing or malformed file, or a type other than +-1
+
+    size_t Rows() const { return header->rows; }
+    EuropeanBatch Batch() const; // spans into the mapping, valid while the file is open
+
+    // Write a batch, the type column only when the batch has one
+    static void Write(const string& path, const EuropeanBatch& batch);
+};
+
+// Result columns {price, delta, gamma} of a mapped file
+class ResultFile {
+private:
+    MappedFile file;
+    const ColumnFileHeader* header;
+    bool writable;
+
+    ResultFile(MappedFile&& mapped, bool writable);
+
+public:
+    ResultFile(const string& path);                 // open an existing file read-only
+    static ResultFile Create(const string& path, size_t rows); // sized and mapped for writing
+
+    size_t Rows() const { return header->rows; }
+    BatchResult Result() const; // writable spans of a created file for EuropeanBatchPricer::Compute, logic_error otherwise
+    span<const double> Price() const;
+    span<const double> Delta() const;
+    span<const double> Gamma() const;
+};
+
+// Streaming CSV interop. The parameter csv has the header line
+//     T,K,sig,r,b,S[,type]
+// with type C/P or 1/-1; without a type column every row gets defaultType.
+void ImportCsv(const string& csvPath, const string& columnPath, OptionType defaultType = Call);
+// One line per row: the parameters followed by the non-empty result columns
+void ExportCsv(const string& csvPath, const EuropeanBatch& batch, span<const double> price,
+               span<const double> delta = {}, span<const double> gamma = {});
+
+#endif /* ColumnFile_hpp */
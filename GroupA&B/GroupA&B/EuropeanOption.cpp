@@ -6,6 +6,10 @@
 //
 
 #include "EuropeanOption.hpp"
+#include "BatchPricer.hpp"
+#include "FiniteDifferenceGreeks.hpp"
+#include "ImpliedVolSolver.hpp"
+#include "PricingCache.hpp"
 #include <iostream>
 #include <cmath>
 #include <vector>
@@ -13,6 +17,8 @@
 
 using namespace boost::math;
 
+PricingCache* EuropeanOption::pricingCache = nullptr;
+
 void EuropeanOption::init()
 {    // Initialise all default values
 
@@ -25,7 +31,8 @@ void EuropeanOption::init()
 
     b = r;            // Black and Scholes stock option model (1973)
     
-    optType = "C";        // European Call Option (this is the default type)
+    optType = Call;        // European Call Option (this is the default type)
+    refresh(AllParts);
 }
 
 void EuropeanOption::copy( const EuropeanOption& o2)
@@ -39,60 +46,33 @@ void EuropeanOption::copy( const EuropeanOption& o2)
     b    = o2.b;
     
     optType = o2.optType;
+    inv = o2.inv;
     
 }
 
-//call price
-double EuropeanOption::CallPrice() const{
-    double tmp = sig * sqrt(T);
-    
-    double d1 = ( log(S/K) + (b+ (sig*sig)*0.5 ) * T )/ tmp;
-    double d2 = d1 - tmp;
-    
-    normal_distribution<> normalDist(0, 1);
-    
-    return (S * exp((b-r)*T) * cdf(normalDist, d1)) - (K * exp(-r * T)* cdf(normalDist, d2));
-}
-
-//put price
-double EuropeanOption::PutPrice() const{
-    double tmp = sig * sqrt(T);
-    
-    double d1 = ( log(S/K) + (b+ (sig*sig)*0.5 ) * T )/ tmp;
-    double d2 = d1 - tmp;
-    
-    normal_distribution<> normalDist(0, 1);
-    
-    return (K * exp((-r)*T) * cdf(normalDist, -d2)) - (S * exp((b-r) * T)* cdf(normalDist, -d1));
-}
-
-double EuropeanOption::CallDelta() const
-{
-    double tmp = sig * sqrt(T);
-
-    double d1 = ( log(S/K) + (b+ (sig*sig)*0.5 ) * T )/ tmp;
-    
-    normal_distribution<> normalDist(0, 1);
-
-    return exp((b-r)*T) * cdf(normalDist, d1);
-}
-
-double EuropeanOption::PutDelta() const
-{
-    double tmp = sig * sqrt(T);
-
-    double d1 = ( log(S/K) + ( b + (sig*sig)*0.5 ) * T )/ tmp;
-    
-    normal_distribution<> normalDist(0, 1);
-    
-    return exp((b-r)*T) * (cdf(normalDist, d1) - 1.0);
+void EuropeanOption::refresh(unsigned parts)
+{ // Recompute the parts of inv that a parameter change made stale
+    if (parts & VolPart) {
+        inv.sqrtT = sqrt(T);
+        inv.vol = sig * inv.sqrtT;
+    }
+    if (parts & DriftPart)
+        inv.drift = (b + (sig*sig)*0.5) * T;
+    if (parts & CarryPart)
+        inv.carry = exp((b-r)*T);
+    if (parts & DiscountPart)
+        inv.df = exp(-r*T);
+    if (parts & StrikePart)
+        inv.logK = log(K);
 }
 
 EuropeanOption::EuropeanOption(){
     init();
 }; // Default call option
 
-EuropeanOption::EuropeanOption(double T_, double K_, double sig_, double r_, double b_, double S_, string OptType): T(T_), K(K_), sig(sig_), r(r_), b(b_), S(S_), optType(OptType){}; // constructor with parameters
+EuropeanOption::EuropeanOption(double T_, double K_, double sig_, double r_, double b_, double S_, string OptType): T(T_), K(K_), sig(sig_), r(r_), b(b_), S(S_), optType(ToOptionType(OptType)){ refresh(AllParts); } // constructor with parameters
+
+EuropeanOption::EuropeanOption(double T_, double K_, double sig_, double r_, double b_, double S_, OptionType type): T(T_), K(K_), sig(sig_), r(r_), b(b_), S(S_), optType(type){ refresh(AllParts); } // constructor with parameters
 
 EuropeanOption::EuropeanOption(const EuropeanOption& o2){
     copy(o2);
@@ -100,16 +80,14 @@ EuropeanOption::EuropeanOption(const EuropeanOption& o2){
 
 EuropeanOption::EuropeanOption (const string& optionType){
     init();
-    optType = optionType;
+    optType = ToOptionType(optionType);
 
-    if (optType == "c")
-        optType = "C";
-    if (optType == "p")
-        optType = "P";
-    
 };    // Create option type
 
-EuropeanOption::EuropeanOption(const vector<vector<double>> parameter_matrix, string opt_type): parameter_matrix(parameter_matrix), optType(opt_type){};
+EuropeanOption::EuropeanOption(const vector<vector<double>> parameter_matrix, string opt_type): parameter_matrix(parameter_matrix){
+    init(); // the scalar fields take the defaults, so inv is defined
+    optType = ToOptionType(opt_type);
+};
 
 EuropeanOption::~EuropeanOption(){} //destructor
 
@@ -123,89 +101,148 @@ EuropeanOption& EuropeanOption::operator = (const EuropeanOption& option2)
     return *this;
 }
 
-//Setters
+//Setters, a spot tick leaves the invariants alone
 void EuropeanOption::setS(double newS) { S = newS; }
-void EuropeanOption::setT(double newT) { T = newT; }
-void EuropeanOption::setSig(double newSig) { sig = newSig; }
-void EuropeanOption::setR(double newR) { r = newR; }
-void EuropeanOption::setB(double newB) { b = newB; }
-void EuropeanOption::setK(double newK) { K = newK; }
+void EuropeanOption::setT(double newT) { T = newT; refresh(AllParts & ~StrikePart); }
+void EuropeanOption::setSig(double newSig) { sig = newSig; refresh(VolPart | DriftPart); }
+void EuropeanOption::setR(double newR) { r = newR; refresh(CarryPart | DiscountPart); }
+void EuropeanOption::setB(double newB) { b = newB; refresh(DriftPart | CarryPart); }
+void EuropeanOption::setK(double newK) { K = newK; refresh(StrikePart); }
 
 // Functions that calculate option price and sensitivities
 double EuropeanOption::Price() const
 {
+    if (pricingCache)
+        return pricingCache->GetOrCompute(PricingModel::European, Parameters(), PriceOf);
+
 
-    if (optType == "C")
+    if (optType == Call)
     {
-        return CallPrice();
+        return Price<Call>();
     }
     else
     {
-        return PutPrice();
+        return Price<Put>();
     }
 }
 
+double EuropeanOption::PriceAt(double spot) const
+{
+    if (optType == Call)
+        return BlackScholesPrice<Call>(inv, K, spot);
+    else
+        return BlackScholesPrice<Put>(inv, K, spot);
+}
+
 double EuropeanOption::Delta() const
 {
-    if (optType == "C")
-        return CallDelta();
+    if (optType == Call)
+        return Delta<Call>();
+    else
+        return Delta<Put>();
+}
+
+double EuropeanOption::PriceOf(const OptionParameters& p)
+{
+    if (p.type == Call)
+        return BlackScholesPrice<Call>(p.T, p.K, p.sig, p.r, p.b, p.S);
     else
-        return PutDelta();
+        return BlackScholesPrice<Put>(p.T, p.K, p.sig, p.r, p.b, p.S);
+}
+
+double EuropeanOption::ImpliedVol(double price) const
+{
+    return ImpliedVolSolver::Solve(Parameters(), price);
 }
 
 double EuropeanOption::Gamma() const{
-    double tmp = sig * sqrt(T);
-    
-    double d1 = ( log(S/K) + (b+ (sig*sig)*0.5 ) * T )/ tmp;
-    
-    normal_distribution<> normalDist(0, 1);
-    
-    return pdf(normalDist, d1) * exp((b-r)*T) /(S * sig * sqrt(T));
+    return BlackScholesGamma(inv, S);
 }
 
 double EuropeanOption::Delta(double h) const{
-    EuropeanOption option1(T, K, sig, r, b, S+h, optType);
-    EuropeanOption option2(T, K, sig, r, b, S-h, optType);
-    return (option1.Price()-option2.Price())/ (2*h);
+    BumpSizes bumps;
+    bumps.spot = h;
+    if (pricingCache) {
+        typedef CachedPricer<EuropeanPricer, PricingModel::European> Cached;
+        return FiniteDifferenceGreeks<Cached>(Cached{pricingCache, EuropeanPricer()}, bumps).Delta(Parameters());
+    }
+    return FiniteDifferenceGreeks<EuropeanPricer>(EuropeanPricer(), bumps).Delta(Parameters());
 }//overload delta method using difference method
 
 double EuropeanOption::Gamma(double h) const{
-    EuropeanOption option1(T, K, sig, r, b, S+h, optType);
-    EuropeanOption option2(T, K, sig, r, b, S, optType);
-    EuropeanOption option3(T, K, sig, r, b, S-h, optType);
-    return (option1.Price() - 2 * option2.Price() + option3.Price())/ (h*h);
+    BumpSizes bumps;
+    bumps.spot = h;
+    if (pricingCache) {
+        typedef CachedPricer<EuropeanPricer, PricingModel::European> Cached;
+        return FiniteDifferenceGreeks<Cached>(Cached{pricingCache, EuropeanPricer()}, bumps).Gamma(Parameters());
+    }
+    return FiniteDifferenceGreeks<EuropeanPricer>(EuropeanPricer(), bumps).Gamma(Parameters());
 }//overload delta method using difference method
 
-vector<double> EuropeanOption::optionMatrix(string mode){
-    vector<double> result = {};
-    for (vector<double> row: parameter_matrix)
-    {
-        EuropeanOption option(row[0], row[1], row[2], row[3], row[4], row[5], optType);
-        if (mode == "price") {
-            result.push_back(option.Price());
-            price_vector = result;
-        } else if (mode == "delta") {
-            result.push_back(option.Delta());
-            delta_vector = result;
-        } else if (mode == "gamma") {
-            result.push_back(option.Gamma());
-            gamma_vector = result;
-        }
-    }
+OptionValues EuropeanOption::Evaluate() const{
+    double sqrtT = inv.sqrtT;
+    double tmp = inv.vol;
+    
+    double d1 = BlackScholesD1(inv, S);
+    double d2 = d1 - tmp;
+    double carry = S * inv.carry; // discounted forward
+    double disc = K * inv.df;     // discounted strike
+    
+    normal_distribution<> normalDist(0, 1);
+    double Nd1 = cdf(normalDist, d1);
+    double Nd2 = cdf(normalDist, d2);
+    double nd1 = pdf(normalDist, d1);
+    
+    OptionValues v;
+    v.callPrice = carry * Nd1 - disc * Nd2;
+    v.putPrice = v.callPrice - carry + disc; // put-call parity with cost of carry
+    v.callDelta = carry / S * Nd1;
+    v.putDelta = v.callDelta - carry / S;
+    v.gamma = nd1 * carry / (S * S * tmp);
+    v.vega = carry * nd1 * sqrtT;
+    v.callTheta = -carry * nd1 * sig / (2.0 * sqrtT) - (b-r) * carry * Nd1 - r * disc * Nd2;
+    v.putTheta = v.callTheta + (b-r) * carry + r * disc;
+    v.callRho = T * disc * Nd2;
+    v.putRho = v.callRho - T * disc;
+    return v;
+} //call, put and all greeks from one set of intermediates
+
+vector<double> EuropeanOption::optionMatrix(string mode, ThreadPool* pool){
+    size_t n = parameter_matrix.size();
+    vector<double> result(n);
+    BatchResult out;
+    if (mode == "price")
+        out.price = result;
+    else if (mode == "delta")
+        out.delta = result;
+    else if (mode == "gamma")
+        out.gamma = result;
+    else
+        return {};
+
+    EuropeanColumns columns(parameter_matrix, optType);
+    EuropeanBatchPricer(simd::DetectSimdLevel(), pool).Compute(columns.Batch(), out);
+
+    if (mode == "price")
+        price_vector = result;
+    else if (mode == "delta")
+        delta_vector = result;
+    else
+        gamma_vector = result;
     return result;
     
 };  //return a price vector given a matrix of parameters
 
 double EuropeanOption::CalltoPut(double c) const{
-    return c + K * exp(-r*T) - S;
+    return c + K * inv.df - S;
 }; //use put-call parity to compute put price
 
 double EuropeanOption::PuttoCall(double p) const{
-    return p + S - K * exp(-r*T);
+    return p + S - K * inv.df;
 }; //use put-call parity to compute call price
 
 bool EuropeanOption::CheckParity(double c, double p) const{
-    double LHS = c + K * exp(-r*T);
+    double LHS = c + K * inv.df;
     double RHS = p + S;
     return LHS == RHS;
 }; //check the put-call parity
@@ -214,10 +251,7 @@ bool EuropeanOption::CheckParity(double c, double p) const{
 void EuropeanOption::toggle()
 { // Change option type (C/P, P/C)
 
-    if (optType == "C")
-        optType = "P";
-    else
-        optType = "C";
+    optType = (optType == Call) ? Put : Call;
     
 }
 
@@ -227,7 +261,7 @@ void EuropeanOption::PrintOptionResult(string mode)
     cout << "  C/P |   T   |   K   |  sig  |   r   |   b   |   S   |  " << mode << "  " << endl;
     cout << "----------------------------------------------------------------" << endl;
     for (int i = 0; i < parameter_matrix.size(); i++){
-        cout << setw(4) << optType << "  |"
+        cout << setw(4) << ToString(optType) << "  |"
              << setw(5) << parameter_matrix[i][0] << "  |"
              << setw(5) << parameter_matrix[i][1] << "  |"
              << setw(5) << parameter_matrix[i][2] << "  |"
@@ -235,11 +269,11 @@ void EuropeanOption::PrintOptionResult(string mode)
              << setw(5) << parameter_matrix[i][4] << "  |"
              << setw(5) << parameter_matrix[i][5] << "  |";
         if (mode == "price"){
-            cout << setw(8) << price_vector[i] << endl;
+            cout << setw(8) << price_vector[i] << '\n';
         } else if (mode == "delta")  {
-            cout << setw(8) << delta_vector[i] << endl;
+            cout << setw(8) << delta_vector[i] << '\n';
         } else if (mode == "gamma") {
-            cout << setw(8) << gamma_vector[i] << endl;
+            cout << setw(8) << gamma_vector[i] << '\n';
         }
     }
     cout << "----------------------------------------------------------------" << endl;
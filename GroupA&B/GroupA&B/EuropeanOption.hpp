@@ -12,8 +12,26 @@
 #include <string>
 #include <vector>
 #include "Option.hpp"
+#include "BlackScholes.hpp"
+#include "ThreadPool.hpp"
 using namespace std;
 
+class PricingCache;
+
+// Both sides and all sensitivities of one option, see EuropeanOption::Evaluate()
+struct OptionValues {
+    double callPrice;
+    double putPrice;
+    double callDelta;
+    double putDelta;
+    double gamma;     // same for call and put
+    double vega;      // same for call and put
+    double callTheta; // -dV/dT, per year
+    double putTheta;
+    double callRho;   // dV/dr with the yield r - b held fixed
+    double putRho;
+};
+
 class EuropeanOption: public Option {
 private:
     double T; //expiry time/maturity
@@ -22,23 +40,24 @@ private:
     double r; //ris-free interest rate
     double b; //cost of carry
     double S; //asset price
-    string optType; // Option name (call, put)
+    OptionType optType; // Option type (call, put)
+    BlackScholesInvariants inv; // spot-independent intermediates, kept current by the setters
     vector<vector<double>> parameter_matrix; //parameter matrix
     vector<double> price_vector; //vector of price
     vector<double> delta_vector; //vector of delta
     vector<double> gamma_vector; // vector of gamma
     void init(); //initalize all default values
     void copy(const EuropeanOption& o2); //copy other options
-    // Kernel funtions for option calculations
-    double CallPrice() const;
-    double PutPrice() const;
-    double CallDelta() const;
-    double PutDelta() const;
+    // Parts of inv, each refreshed when one of the fields it depends on changes
+    enum InvariantPart : unsigned { VolPart = 1, DriftPart = 2, CarryPart = 4, DiscountPart = 8, StrikePart = 16, AllParts = 31 };
+    void refresh(unsigned parts);
+    static PricingCache* pricingCache; //memo behind Price() and the difference greeks, null by default
 
 public:
     
     EuropeanOption();                            // Default call option
     EuropeanOption(double T, double K, double sig, double r, double b, double S, string OptType);
+    EuropeanOption(double T, double K, double sig, double r, double b, double S, OptionType type);
     EuropeanOption(const EuropeanOption& o2);    // Copy constructor
     EuropeanOption (const string& optionType);    // Create option type
     EuropeanOption(const vector<vector<double>> parameter_matrix, string opt_type); // construct by matrix
@@ -53,20 +72,32 @@ public:
     void setB(double newB);
     void setK(double newK);
     
+    // Kernel funtions for option calculations, the type is resolved at compile time
+    template <OptionType type> double Price() const { return BlackScholesPrice<type>(inv, K, S); }
+    template <OptionType type> double Delta() const { return BlackScholesDelta<type>(inv, S); }
+
     // Functions that calculate option price and sensitivities
     double Price() const;
     double Delta() const;
     double Gamma() const;
     double Delta(double h) const; //overload delta method using difference method
     double Gamma(double h) const; //overload gamma method using difference method
-    vector<double> optionMatrix(string mode); //return a vector of price, delta, or gamma given a matrix of parameters
+    double PriceAt(double spot) const; //price at another spot from the cached invariants, one log and two cdfs
+    OptionValues Evaluate() const; //call, put and all greeks from one set of intermediates
+    vector<double> optionMatrix(string mode, ThreadPool* pool = &ThreadPool::Shared()); //return a vector of price, delta, or gamma given a matrix of parameters, rows over pool
     double CalltoPut(double c) const; //use put-call parity to compute put price
     double PuttoCall(double p) const; //use put-call parity to compute call price
+    double ImpliedVol(double price) const; //volatility that reproduces the price, NaN outside the no-arbitrage bounds
     
     bool CheckParity(double c, double p) const; //check the put-call parity
     
     // Modifier functions
     void toggle();        // Change option type (C/P, P/C)
+    OptionType type() const { return optType; }
+    OptionParameters Parameters() const { return OptionParameters{T, K, sig, r, b, S, optType}; }
+    static double PriceOf(const OptionParameters& p); //closed-form price of a parameter block
+    static void SetPricingCache(PricingCache* cache) { pricingCache = cache; } //null switches caching off, set before pricing starts
+    static PricingCache* GetPricingCache() { return pricingCache; }
     
     void PrintOptionResult(string mode); //Print price result
     
@@ -0,0 +1,294 @@
+//
+//  ImpliedVolSolver.cpp
+//  GroupA&B
+//  Implied volatility kernels, scalar reference and SIMD
+//  Created by Kevin on 10/18/26.
+//
+
+#include "ImpliedVolSolver.hpp"
+#include "Metrics.hpp"
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <boost/math/distributions/normal.hpp>
+
+using namespace boost::math;
+using namespace simd;
+
+static const double NaN = numeric_limits<double>::quiet_NaN();
+static const double ZeroPrice = 1e-15; // normalised prices down to -ZeroPrice count as intrinsic
+
+// Scalar reference path, w = +1 call, -1 put
+static double SolveRow(double T, double K, double r, double b, double S, double price, double w, IVStatus& status)
+{
+    if (!(T > 0.0 && K > 0.0 && S > 0.0 && price >= 0.0)) {
+        status = IVStatus::InvalidInput;
+        return NaN;
+    }
+
+    // normalised out-of-the-money quote
+    double F = S * exp(b * T);
+    double x = log(F / K);
+    double c = price * exp(r * T);
+    if (w * x > 0.0)
+        c -= w * (F - K); // in the money, take the other side by parity
+    double beta = c / sqrt(F * K);
+    x = -fabs(x);
+    double bmax = exp(0.5 * x);
+
+    if (beta < -ZeroPrice) {
+        status = IVStatus::BelowIntrinsic;
+        return NaN;
+    }
+    if (beta >= bmax) {
+        status = IVStatus::AboveMaximum;
+        return NaN;
+    }
+    status = IVStatus::Converged;
+    if (beta <= 0.0)
+        return 0.0;
+
+    normal_distribution<> normalDist(0, 1);
+    auto black = [&](double s) { return bmax * cdf(normalDist, x / s + 0.5 * s) - cdf(normalDist, x / s - 0.5 * s) / bmax; };
+
+    // initial guess on either side of the inflection point
+    double sc = max(sqrt(-2.0 * x), 1e-300);
+    double bc = black(sc);
+    bool lower = beta < bc;
+    double s = lower ? sqrt(2.0 * x * x / (-x - 4.0 * log(beta / bc)))
+                     : -2.0 * quantile(normalDist, (bmax - beta) / (bmax - bc) * cdf(normalDist, -0.5 * sc));
+
+    double lo = 0.0, hi = HUGE_VAL; // bracket of s
+    for (int it = 0; it < ImpliedVolSolver::MaxIterations; it++) {
+        double d1 = x / s + 0.5 * s;
+        double d2 = d1 - s;
+        double bs = bmax * cdf(normalDist, d1) - cdf(normalDist, d2) / bmax;
+        double vega = bmax * pdf(normalDist, d1);
+        double volga = vega * d1 * d2 / s;
+        if (bs < beta) lo = s; else hi = s;
+
+        double f, f1, f2;
+        if (lower) { // ln b(s) = ln beta
+            bs = max(bs, 1e-300);
+            f = log(bs / beta);
+            f1 = vega / bs;
+            f2 = volga / bs - f1 * f1;
+        } else {
+            f = bs - beta;
+            f1 = vega;
+            f2 = volga;
+        }
+
+        double newton = -f / f1;
+        double next = s + newton / max(1.0 + 0.5 * newton * f2 / f1, 0.5);
+        if (fabs(next - s) <= ImpliedVolSolver::Tolerance * s)
+            return next / sqrt(T);
+        if (!(next >= lo && next <= hi)) // outside the bracket, bisect
+            next = hi < HUGE_VAL ? 0.5 * (lo + hi) : 2.0 * s;
+        s = next;
+    }
+    status = IVStatus::NoConvergence;
+    return s / sqrt(T);
+}
+
+// Rows [i, i + count) with one vector of W lanes, count <= W. Partial blocks are padded with a valid quote.
+template <class V, class Ops, int Omega>
+SIMD_INLINE void SolveBlock(const ImpliedVolBatch& in, const ImpliedVolResult& out, size_t i, size_t count)
+{
+    typedef Mask<V> I;
+    const int W = Lanes<V>();
+    V T, K, r, b, S, price, w;
+    if (count == (size_t)W) {
+        T = Load<V>(&in.T[i]); K = Load<V>(&in.K[i]); r = Load<V>(&in.r[i]);
+        b = Load<V>(&in.b[i]); S = Load<V>(&in.S[i]); price = Load<V>(&in.price[i]);
+    } else {
+        T = K = S = Broadcast<V>(1.0); price = Broadcast<V>(0.1); r = b = V{};
+        for (size_t j = 0; j < count; j++) {
+            T[j] = in.T[i + j]; K[j] = in.K[i + j]; r[j] = in.r[i + j];
+            b[j] = in.b[i + j]; S[j] = in.S[i + j]; price[j] = in.price[i + j];
+        }
+    }
+    w = Broadcast<V>(Omega != 0 ? Omega : 1.0);
+    if (Omega == 0)
+        for (size_t j = 0; j < count; j++)
+            w[j] = in.type[i + j];
+
+    I valid = (T > 0.0) & (K > 0.0) & (S > 0.0) & (price >= 0.0);
+    T = Select<V>(valid, T, Broadcast<V>(1.0)); // keep the math finite in invalid lanes
+    K = Select<V>(valid, K, Broadcast<V>(1.0));
+    S = Select<V>(valid, S, Broadcast<V>(1.0));
+
+    V F = S * Exp(b * T);
+    V x = Log(F / K);
+    V c = price * Exp(r * T);
+    c = Select<V>(w * x > 0.0, c - w * (F - K), c);
+    V beta = c / Ops::Sqrt(F * K);
+    x = -Abs(x);
+    V bmax = Exp(0.5 * x);
+
+    I below = beta < -ZeroPrice;
+    I above = beta >= bmax;
+    I zero = (beta <= 0.0) & ~below;
+    I active = valid & ~below & ~above & ~zero;
+    V betaIt = Select<V>(active, beta, 0.5 * bmax); // a harmless quote for the inactive lanes
+
+    V sc = Max(Ops::Sqrt(-2.0 * x), Broadcast<V>(1e-300));
+    V bc = bmax * NormalCdf(x / sc + 0.5 * sc) - NormalCdf(x / sc - 0.5 * sc) / bmax;
+    I lower = betaIt < bc;
+    V ratio = Select<V>(lower, betaIt / bc, Broadcast<V>(0.5));
+    V sLower = Ops::Sqrt(2.0 * x * x / (-x - 4.0 * Log(ratio)));
+    V u = Select<V>(lower, Broadcast<V>(0.25), (bmax - betaIt) / (bmax - bc) * NormalCdf(-0.5 * sc));
+    V sUpper = -2.0 * NormalInv<V, Ops>(u);
+    V s = Select<V>(lower, sLower, sUpper);
+
+    V lo{}, hi = Broadcast<V>(HUGE_VAL);
+    I done = ~active;
+    for (int it = 0; it < ImpliedVolSolver::MaxIterations; it++) {
+        V d1 = x / s + 0.5 * s;
+        V d2 = d1 - s;
+        V pdf1;
+        V bs = bmax * NormalCdf(d1, pdf1) - NormalCdf(d2) / bmax;
+        V vega = bmax * pdf1;
+        V volga = vega * d1 * d2 / s;
+        I under = bs < betaIt;
+        lo = Select<V>(under, s, lo);
+        hi = Select<V>(under, hi, s);
+
+        V bsl = Max(bs, Broadcast<V>(1e-300));
+        V g1 = vega / bsl;
+        V f = Select<V>(lower, Log(bsl / betaIt), bs - betaIt);
+        V f1 = Select<V>(lower, g1, vega);
+        V f2 = Select<V>(lower, volga / bsl - g1 * g1, volga);
+
+        V newton = -f / f1;
+        V next = s + newton / Max(1.0 + 0.5 * newton * f2 / f1, Broadcast<V>(0.5));
+        I conv = Abs(next - s) <= ImpliedVolSolver::Tolerance * s;
+        I inside = conv | ((next >= lo) & (next <= hi));
+        next = Select<V>(inside, next, Select<V>(hi < HUGE_VAL, 0.5 * (lo + hi), 2.0 * s));
+        s = Select<V>(done, s, next);
+        done |= conv;
+
+        bool all = true;
+        for (int j = 0; j < W; j++)
+            all = all && done[j];
+        if (all)
+            break;
+    }
+
+    V sig = s / Ops::Sqrt(T);
+    sig = Select<V>(zero, V{}, sig);
+    sig = Select<V>(valid & ~below & ~above, sig, Broadcast<V>(NaN));
+
+    for (size_t j = 0; j < count; j++) {
+        if (!out.sig.empty())
+            out.sig[i + j] = sig[j];
+        if (!out.status.empty())
+            out.status[i + j] = !valid[j] ? IVStatus::InvalidInput
+                              : below[j] ? IVStatus::BelowIntrinsic
+                              : above[j] ? IVStatus::AboveMaximum
+                              : done[j] ? IVStatus::Converged : IVStatus::NoConvergence;
+    }
+}
+
+template <class V, class Ops, int Omega>
+SIMD_INLINE void SolveVector(const ImpliedVolBatch& in, const ImpliedVolResult& out, size_t begin, size_t end)
+{
+    const size_t W = Lanes<V>();
+    size_t i = begin;
+    for (; i + W <= end; i += W)
+        SolveBlock<V, Ops, Omega>(in, out, i, W);
+    if (i < end)
+        SolveBlock<V, Ops, Omega>(in, out, i, end - i);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+template <int Omega> __attribute__((target("avx512f")))
+static void SolveAvx512(const ImpliedVolBatch& in, const ImpliedVolResult& out, size_t begin, size_t end)
+{
+    SolveVector<vd8, Avx512Ops, Omega>(in, out, begin, end);
+}
+
+template <int Omega> __attribute__((target("avx2,fma")))
+static void SolveAvx2(const ImpliedVolBatch& in, const ImpliedVolResult& out, size_t begin, size_t end)
+{
+    SolveVector<vd4, Avx2Ops, Omega>(in, out, begin, end);
+}
+
+template <int Omega> __attribute__((target("sse2")))
+static void Solve128(const ImpliedVolBatch& in, const ImpliedVolResult& out, size_t begin, size_t end)
+{
+    SolveVector<vd2, Sse2Ops, Omega>(in, out, begin, end);
+}
+#else
+template <int Omega>
+static void Solve128(const ImpliedVolBatch& in, const ImpliedVolResult& out, size_t begin, size_t end)
+{
+    SolveVector<vd2, GenericOps, Omega>(in, out, begin, end);
+}
+#endif
+
+template <int Omega>
+static void SolveRange(SimdLevel level, const ImpliedVolBatch& in, const ImpliedVolResult& out, size_t begin, size_t end)
+{
+    switch (level) {
+#if defined(__x86_64__) || defined(__i386__)
+    case SimdLevel::Simd512: SolveAvx512<Omega>(in, out, begin, end); break;
+    case SimdLevel::Simd256: SolveAvx2<Omega>(in, out, begin, end); break;
+#endif
+    case SimdLevel::Simd128: Solve128<Omega>(in, out, begin, end); break;
+    default:
+        for (size_t i = begin; i < end; i++) {
+            IVStatus status;
+            double sig = SolveRow(in.T[i], in.K[i], in.r[i], in.b[i], in.S[i], in.price[i],
+                                  Omega != 0 ? Omega : in.type[i], status);
+            if (!out.sig.empty()) out.sig[i] = sig;
+            if (!out.status.empty()) out.status[i] = status;
+        }
+    }
+}
+
+ImpliedVolSolver::ImpliedVolSolver(): level(DetectSimdLevel()), pool(&ThreadPool::Shared()) {}
+
+ImpliedVolSolver::ImpliedVolSolver(SimdLevel level_, ThreadPool* pool_): level(min(level_, DetectSimdLevel())), pool(pool_) {}
+
+void ImpliedVolSolver::Compute(const ImpliedVolBatch& in, const ImpliedVolResult& out) const
+{
+    size_t n = in.size();
+    metrics::ScopedTimer timer(metrics::Engine::ImpliedVol, metrics::Phase::Kernel);
+    metrics::count(metrics::Engine::ImpliedVol, metrics::Counter::OptionsPriced, n);
+    if (n < 8 && level != SimdLevel::Scalar) { // shorter than one vector
+        ImpliedVolSolver(SimdLevel::Scalar, nullptr).Compute(in, out, 0, n);
+    } else if (pool == nullptr || n < ParallelThreshold) {
+        Compute(in, out, 0, n);
+    } else {
+        pool->ParallelFor(n, ChunkSize, [&](size_t begin, size_t end) { Compute(in, out, begin, end); });
+    }
+}
+
+void ImpliedVolSolver::Compute(const ImpliedVolBatch& in, const ImpliedVolResult& out, size_t begin, size_t end) const
+{
+    size_t n = in.size();
+    if (in.T.size() != n || in.K.size() != n || in.r.size() != n || in.b.size() != n
+        || in.price.size() != n || (!in.type.empty() && in.type.size() != n))
+        throw invalid_argument("ImpliedVolSolver: input columns differ in length");
+    if ((!out.sig.empty() && out.sig.size() != n) || (!out.status.empty() && out.status.size() != n))
+        throw invalid_argument("ImpliedVolSolver: output column does not match batch size");
+    if (begin > end || end > n)
+        throw out_of_range("ImpliedVolSolver: row range outside the batch");
+
+    if (!in.type.empty())
+        SolveRange<0>(level, in, out, begin, end);
+    else if (in.allType == Call)
+        SolveRange<Call>(level, in, out, begin, end);
+    else
+        SolveRange<Put>(level, in, out, begin, end);
+}
+
+double ImpliedVolSolver::Solve(const OptionParameters& p, double price, IVStatus* status)
+{
+    IVStatus rowStatus;
+    double sig = SolveRow(p.T, p.K, p.r, p.b, p.S, price, p.type, rowStatus);
+    if (status != nullptr)
+        *status = rowStatus;
+    return sig;
+}
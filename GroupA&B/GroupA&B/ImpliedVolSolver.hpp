@@ -0,0 +1,85 @@
+//
+//  ImpliedVolSolver.hpp
+//  GroupA&B
+//  Batch implied volatility of European quotes, the inverse of EuropeanOption::Price()
+//  Created by Kevin on 10/18/26.
+//
+//  Every quote is reduced to Jaeckel's normalised form: forward F = S e^{bT},
+//  x = ln(F/K), an in-the-money quote becomes the out-of-the-money one by
+//  put-call parity, and beta = undiscounted OTM price / sqrt(F K) is matched by
+//      b(s) = e^{x/2} N(x/s + s/2) - e^{-x/2} N(x/s - s/2),  x <= 0,  s = sig sqrt(T).
+//  The initial guess comes from the inflection point s_c = sqrt(2|x|) (Jaeckel,
+//  "By Implication"): an asymptotic formula below b(s_c) and an inverse normal
+//  above it. Then safeguarded Halley steps with the analytic vega b'(s) and
+//  volga b''(s) = b'(s) d1 d2 / s; below b(s_c) they solve ln b(s) = ln beta,
+//  which is almost linear there. A step leaving the bracket of s known so far
+//  becomes a bisection. Typical quotes converge in two or three steps.
+//
+
+#ifndef ImpliedVolSolver_hpp
+#define ImpliedVolSolver_hpp
+
+#include <span>
+#include "Option.hpp"
+#include "SimdMath.hpp"
+#include "ThreadPool.hpp"
+
+using namespace std;
+
+// Outcome of one row
+enum class IVStatus : unsigned char {
+    Converged,      // step below the tolerance
+    NoConvergence,  // MaxIterations reached, the last iterate is returned
+    BelowIntrinsic, // price below the no-arbitrage lower bound, vol is NaN
+    AboveMaximum,   // price at or above the upper bound, vol is NaN
+    InvalidInput    // T, K, S not positive or price negative or not a number, vol is NaN
+};
+
+// Contiguous quote columns, one entry per option
+struct ImpliedVolBatch {
+    span<const double> T;     // expiry time/maturity
+    span<const double> K;     // strike price
+    span<const double> r;     // risk-free interest rate
+    span<const double> b;     // cost of carry
+    span<const double> S;     // asset price
+    span<const double> price; // quoted option price
+    span<const OptionType> type; // per-row type, empty for a homogeneous batch
+    OptionType allType = Call;    // type of every row when the type column is empty
+
+    size_t size() const { return S.size(); }
+};
+
+// Caller-owned output columns. An empty span means "do not compute".
+struct ImpliedVolResult {
+    span<double> sig;
+    span<IVStatus> status;
+};
+
+// Dispatch as in EuropeanBatchPricer: scalar rows for short batches, the widest
+// SIMD kernel up to ParallelThreshold rows, ChunkSize row ranges over the pool
+// above. Lanes that converge are frozen while the others iterate.
+class ImpliedVolSolver {
+private:
+    simd::SimdLevel level;
+    ThreadPool* pool;
+
+public:
+    static const size_t ParallelThreshold = 8192;
+    static const size_t ChunkSize = 2048;
+    static const int MaxIterations = 12;
+    static constexpr double Tolerance = 1e-13; // relative change of s in the last step
+
+    ImpliedVolSolver(); // widest kernel the cpu supports, shared thread pool
+    ImpliedVolSolver(simd::SimdLevel level, ThreadPool* pool = &ThreadPool::Shared());
+
+    simd::SimdLevel Level() const { return level; }
+
+    void Compute(const ImpliedVolBatch& batch, const ImpliedVolResult& result) const;
+    // Rows [begin, end) only, on the calling thread
+    void Compute(const ImpliedVolBatch& batch, const ImpliedVolResult& result, size_t begin, size_t end) const;
+
+    // One quote, p.sig is ignored; the scalar reference kernel
+    static double Solve(const OptionParameters& p, double price, IVStatus* status = nullptr);
+};
+
+#endif /* ImpliedVolSolver_hpp */
@@ -6,6 +6,7 @@
 //
 
 #include "Option.hpp"
+#include <cmath>
 
 // Default constructor
 Option::Option()
@@ -27,10 +28,28 @@ Option& Option::operator= (const Option& option2)
     return *this;
 }
 
+OptionType ToOptionType(const string& name)
+{
+    return (name == "C" || name == "c") ? Call : Put;
+}
+
+string ToString(OptionType type)
+{
+    return type == Call ? "C" : "P";
+}
+
 //global funuction to generete a mesh array
+//every node is start + i * h, so there is no drift from repeated x += h,
+//and a node within rounding of end is placed exactly on end
 vector<double> meshArray(double start, double end, double h) {
-    vector<double> mesh;
-    for (double x = start; x <= end; x += h)
-        mesh.push_back(x);
+    const double eps = 1e-9;
+    long n = (long)floor((end - start) / h + eps);
+    if (n < 0)
+        return vector<double>();
+    vector<double> mesh(n + 1);
+    for (long i = 0; i <= n; i++)
+        mesh[i] = start + i * h;
+    if (fabs(mesh[n] - end) < eps * h)
+        mesh[n] = end;
     return mesh;
 }
@@ -5,11 +5,33 @@
 //  Created by Kevin on 10/24/25.
 //
 #include <vector>
+#include <string>
 using namespace std;
 #ifndef Option_hpp
 #define Option_hpp
 
 #include <stdio.h>
+
+// Option type. The value is the payoff sign, so kernels can use it branch-free.
+enum OptionType : int { Call = 1, Put = -1 };
+
+OptionType ToOptionType(const string& name); // "C"/"c" is a call, anything else a put
+string ToString(OptionType type);            // "C" or "P"
+
+// Closed form a parameter block is priced with
+enum class PricingModel : unsigned char { European, PerpetualAmerican };
+
+// Plain parameter block shared by the pricers, perpetual options ignore T
+struct OptionParameters {
+    double T;   // expiry time/maturity
+    double K;   // strike price
+    double sig; // volatility
+    double r;   // risk-free interest rate
+    double b;   // cost of carry
+    double S;   // asset price
+    OptionType type;
+};
+
 class Option
 {
 public:
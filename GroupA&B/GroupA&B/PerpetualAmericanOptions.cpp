@@ -6,11 +6,15 @@
 //
 
 #include "PerpetualAmericanOptions.hpp"
+#include "PerpetualBatchPricer.hpp"
+#include "PricingCache.hpp"
 #include <cmath>
 #include <iostream>
 #include <vector>
 #include <iomanip>
 
+PricingCache* PerpetualAmericanOption::pricingCache = nullptr;
+
 void PerpetualAmericanOption::init()
 {    // Initialise all default values
     // Default values
@@ -18,7 +22,8 @@ void PerpetualAmericanOption::init()
     sig= 0.1;
     K = 100.0;
     b = r;            // Black and Scholes stock option model (1973)
-    optType = "C"; // PerpetualAmerican Call Option (this is the default type)
+    optType = Call; // PerpetualAmerican Call Option (this is the default type)
+    refresh(AllParts);
 }
 
 void PerpetualAmericanOption::copy( const PerpetualAmericanOption& o2)
@@ -30,20 +35,42 @@ void PerpetualAmericanOption::copy( const PerpetualAmericanOption& o2)
     S    = o2.S;
     b    = o2.b;
     optType = o2.optType;
+    inv = o2.inv;
     
 }//copy other option
 
+void PerpetualAmericanOption::refresh(unsigned parts)
+{ // Same expressions as PerpetualAmericanPrice<>, split at the spot
+    const double w = optType;
+    if (parts & ExponentPart) {
+        double sig2 = sig*sig;
+        double fac = b/sig2 - 0.5; fac *= fac;
+        inv.y = 0.5 - b/sig2 + w * sqrt(fac + 2.0*r/sig2);
+        inv.degenerate = PerpetualDegenerate(optType, inv.y, r, b);
+    }
+    // scale and ratio depend on K and y, so every part refreshes them
+    inv.scale = K / (w * (inv.y - 1.0));
+    inv.ratio = (inv.y - 1.0) / (inv.y * K);
+}
+
 PerpetualAmericanOption::PerpetualAmericanOption()
 { // Default call option
     init();
 }
 
-PerpetualAmericanOption::PerpetualAmericanOption(double K, double sig, double r, double b, double S, string opt_type): K(K), sig(sig), r(r), b(b), S(S), optType(opt_type) {}
+PerpetualAmericanOption::PerpetualAmericanOption(double K, double sig, double r, double b, double S, string opt_type): K(K), sig(sig), r(r), b(b), S(S), optType(ToOptionType(opt_type)) { refresh(AllParts); }
+//constructor with parameter
+
+PerpetualAmericanOption::PerpetualAmericanOption(double K, double sig, double r, double b, double S, OptionType type): K(K), sig(sig), r(r), b(b), S(S), optType(type) { refresh(AllParts); }
 //constructor with parameter
 
 
-PerpetualAmericanOption::PerpetualAmericanOption(const vector<vector<double>> parameter_matrix, string opt_type):parameter_matrix(parameter_matrix), optType(opt_type)
-{}
+PerpetualAmericanOption::PerpetualAmericanOption(const vector<vector<double>> parameter_matrix, string opt_type):parameter_matrix(parameter_matrix)
+{ // the scalar fields take the defaults, so inv is defined
+    init();
+    optType = ToOptionType(opt_type);
+    refresh(AllParts);
+}
 // Constructor with matrix
 
 PerpetualAmericanOption::PerpetualAmericanOption(const PerpetualAmericanOption& o2)
@@ -54,12 +81,8 @@ PerpetualAmericanOption::PerpetualAmericanOption(const PerpetualAmericanOption&
 PerpetualAmericanOption::PerpetualAmericanOption(const string& option_type)
 {    // Create option type
     init();
-    optType = option_type;
-
-    if (optType == "c")
-        optType = "C";
-    if (optType == "p")
-        optType = "P";
+    optType = ToOptionType(option_type);
+    refresh(AllParts); // init() refreshed for a call
 }
 
 PerpetualAmericanOption& PerpetualAmericanOption::operator = (const PerpetualAmericanOption& option2)
@@ -73,64 +96,45 @@ PerpetualAmericanOption& PerpetualAmericanOption::operator = (const PerpetualAme
 
 PerpetualAmericanOption::~PerpetualAmericanOption(){}//destructor
 
-//Setters
+//Setters, a spot tick leaves the invariants alone
 void PerpetualAmericanOption::setS(double newS) { S = newS; }
-void PerpetualAmericanOption::setSig(double newSig) { sig = newSig; }
-void PerpetualAmericanOption::setR(double newR) { r = newR; }
-void PerpetualAmericanOption::setB(double newB) { b = newB; }
-void PerpetualAmericanOption::setK(double newK) { K = newK; }
+void PerpetualAmericanOption::setSig(double newSig) { sig = newSig; refresh(AllParts); }
+void PerpetualAmericanOption::setR(double newR) { r = newR; refresh(AllParts); }
+void PerpetualAmericanOption::setB(double newB) { b = newB; refresh(AllParts); }
+void PerpetualAmericanOption::setK(double newK) { K = newK; refresh(StrikePart); }
 
-double PerpetualAmericanOption::CallPrice() const
+// Functions that calculate option price and sensitivities
+double PerpetualAmericanOption::Price() const
 {
-    double sig2 = sig*sig;
-    double fac = b/sig2 - 0.5; fac *= fac;
-    double y1 = 0.5 - b/sig2 + sqrt(fac + 2.0*r/sig2);
-    if (1.0 == y1)
-        return S;
+    if (pricingCache)
+        return pricingCache->GetOrCompute(PricingModel::PerpetualAmerican, Parameters(), PriceOf);
 
-    double fac2 = ((y1 - 1.0)*S) / (y1 * K);
-    double c = K * pow(fac2, y1) / (y1 - 1.0);
-
-    return c;
+    return PriceAt(S);
 }
 
-double PerpetualAmericanOption::PutPrice() const
+double PerpetualAmericanOption::PriceAt(double spot) const
 {
-    double sig2 = sig*sig;
-    double fac = b/sig2 - 0.5; fac *= fac;
-    double y2 = 0.5 - b/sig2 - sqrt(fac + 2.0*r/sig2);
-    
-    if (0.0 == y2)
-        return S;
-
-    double fac2 = ((y2 - 1.0)*S) / (y2 * K);
-    double p = K * pow(fac2, y2) / (1.0 - y2);
-
-    return p;
-
+    if (inv.degenerate)
+        return spot;
+    return inv.scale * pow(inv.ratio * spot, inv.y);
 }
 
-// Functions that calculate option price and sensitivities
-double PerpetualAmericanOption::Price() const
+double PerpetualAmericanOption::PriceOf(const OptionParameters& p)
 {
-    if (optType == "C")
-    {
-        return CallPrice();
-    }
+    if (p.type == Call)
+        return PerpetualAmericanPrice<Call>(p.K, p.sig, p.r, p.b, p.S);
     else
-    {
-        return PutPrice();
-    }
+        return PerpetualAmericanPrice<Put>(p.K, p.sig, p.r, p.b, p.S);
 }
 
 // Calculate option prices using parater matrix
-vector<double> PerpetualAmericanOption::PriceWithMatrix()
+vector<double> PerpetualAmericanOption::PriceWithMatrix(ThreadPool* pool)
 {
-    for (vector<double> row: parameter_matrix)
-    {
-        PerpetualAmericanOption option(row[0], row[1], row[2], row[3], row[4], optType);
-        price_vector.push_back(option.Price());
-    }
+    PerpetualColumns columns(parameter_matrix, optType);
+    price_vector.resize(parameter_matrix.size()); // one price per row, repeated calls overwrite
+    PerpetualBatchResult out;
+    out.price = price_vector;
+    PerpetualAmericanBatchPricer(simd::DetectSimdLevel(), pool).Compute(columns.Batch(), out);
     return price_vector;
 }
 
@@ -140,13 +144,13 @@ void PerpetualAmericanOption::PrintPriceResult()
     cout << "  C/P |   K   |  sig  |   r   |   b   |   S   |  price  " << endl;
     cout << "----------------------------------------------------------------" << endl;
     for (int i = 0; i < parameter_matrix.size(); i++){
-        cout << setw(4) << optType << "  |"
+        cout << setw(4) << ToString(optType) << "  |"
              << setw(5) << parameter_matrix[i][0] << "  |"
              << setw(5) << parameter_matrix[i][1] << "  |"
              << setw(5) << parameter_matrix[i][2] << "  |"
              << setw(5) << parameter_matrix[i][3] << "  |"
              << setw(5) << parameter_matrix[i][4] << "  |"
-             << setw(8) << price_vector[i] <<  endl;  
+             << setw(8) << price_vector[i] << '\n';
     }
     cout << "----------------------------------------------------------------" << endl;
 }
@@ -154,9 +158,7 @@ void PerpetualAmericanOption::PrintPriceResult()
 // Modifier functions
 void PerpetualAmericanOption::toggle()
 { // Change option type (C/P, P/C)
-    if (optType == "C")
-        optType = "P";
-    else
-        optType = "C";
+    optType = (optType == Call) ? Put : Call;
+    refresh(AllParts);
 }
 
@@ -8,12 +8,23 @@
 #ifndef PerpetualAmericanOptions_hpp
 #define PerpetualAmericanOptions_hpp
 
+#include <cmath>
 #include <string>
 #include <vector>
 #include "Option.hpp"
+#include "ThreadPool.hpp"
 
 using namespace std;
 
+class PricingCache;
+
+// The spot-independent part of the closed form, price = scale * (ratio S)^y
+struct PerpetualInvariants {
+    double y = 0.0;          // y1 (the + root) for calls, y2 (the - root) for puts
+    double scale = 0.0;      // K / (w (y - 1))
+    double ratio = 0.0;      // (y - 1) / (y K)
+    bool degenerate = false; // y at the pole, the price is S
+};
 
 class PerpetualAmericanOption: public Option{
 private:
@@ -22,18 +33,20 @@ private:
     double r;        // risk-free interest rate
     double b;        // cost of carry
     double S;        // asset price
-    string optType;  // option type
+    OptionType optType;  // option type
+    PerpetualInvariants inv; // kept current by the setters and toggle()
     vector<vector<double>> parameter_matrix; // parameter matrix
     vector<double> price_vector; //price vector
     void init();   //initalize american option
     void copy(const PerpetualAmericanOption& o2);   //copy
-    // Kernel funtions for option calculations
-    double CallPrice() const;
-    double PutPrice() const;
+    enum InvariantPart : unsigned { ExponentPart = 1, StrikePart = 2, AllParts = 3 };
+    void refresh(unsigned parts);   //recompute the stale parts of inv
+    static PricingCache* pricingCache; //memo behind Price(), null by default
     
 public:
     PerpetualAmericanOption(); // Default call option
-    PerpetualAmericanOption(double r, double sig, double K, double b, double S, string opt_type); //constructor with parameters
+    PerpetualAmericanOption(double K, double sig, double r, double b, double S, string opt_type); //constructor with parameters
+    PerpetualAmericanOption(double K, double sig, double r, double b, double S, OptionType type); //constructor with parameters
     PerpetualAmericanOption(const PerpetualAmericanOption& option2);    // Copy constructor
     PerpetualAmericanOption(const string& option_type);        // Create option type
     PerpetualAmericanOption(const vector<vector<double>> parameter_matrix, string opt_type); // construct by matrix
@@ -46,13 +59,50 @@ public:
     void setR(double newR);
     void setB(double newB);
     void setK(double newK);
+    // Kernel funtion for option calculations, the type is resolved at compile time
+    template <OptionType type> double Price() const;
     // Functions that calculate option price and sensitivities
     double Price() const;
+    double PriceAt(double spot) const; //price at another spot from the cached invariants, one pow
     
     // Modifier functions
     void toggle();        // Change option type (C/P, P/C)
-    vector<double> PriceWithMatrix(); //compute price given matrix of paramters
+    OptionType type() const { return optType; }
+    OptionParameters Parameters() const { return OptionParameters{0.0, K, sig, r, b, S, optType}; }
+    const PerpetualInvariants& Invariants() const { return inv; } //exponent and scale of the closed form
+    static double PriceOf(const OptionParameters& p); //closed-form price of a parameter block, T is ignored
+    static void SetPricingCache(PricingCache* cache) { pricingCache = cache; } //null switches caching off, set before pricing starts
+    static PricingCache* GetPricingCache() { return pricingCache; }
+    vector<double> PriceWithMatrix(ThreadPool* pool = &ThreadPool::Shared()); //compute price given matrix of paramters, rows over pool
     void PrintPriceResult(); //print price vector
 };
 
+// Exponent at the pole, where the price is S: y1 == 1 for calls, which holds
+// exactly when b == r (r >= 0) but may round to either side of 1 there, and
+// y2 == 0 for puts. Shared by every pricer so they agree on the pole.
+inline bool PerpetualDegenerate(OptionType type, double y, double r, double b)
+{
+    return type == Call ? (1.0 == y || (b == r && r >= 0.0)) : 0.0 == y;
+}
+
+template <OptionType type>
+inline double PerpetualAmericanPrice(double K, double sig, double r, double b, double S)
+{ // y1 (the + root) for calls, y2 (the - root) for puts
+    const double w = type; // +1 call, -1 put
+    double sig2 = sig*sig;
+    double fac = b/sig2 - 0.5; fac *= fac;
+    double y = 0.5 - b/sig2 + w * sqrt(fac + 2.0*r/sig2);
+    if (PerpetualDegenerate(type, y, r, b))
+        return S;
+
+    double fac2 = ((y - 1.0)*S) / (y * K);
+    return K * pow(fac2, y) / (w * (y - 1.0));
+}
+
+template <OptionType type>
+double PerpetualAmericanOption::Price() const
+{
+    return PerpetualAmericanPrice<type>(K, sig, r, b, S);
+}
+
 #endif /* PerpetualAmericanOptions_hpp */
@@ -0,0 +1,215 @@
+//
+//  PerpetualBatchPricer.cpp
+//  GroupA&B
+//  Batch pricer for perpetual American options implementation
+//  Created by Kevin on 10/18/26.
+//
+
+#include "PerpetualBatchPricer.hpp"
+#include "PerpetualAmericanOptions.hpp"
+#include "Metrics.hpp"
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+
+using namespace simd;
+
+size_t PerpetualAmericanBatchPricer::KeyHash::operator () (const Key& k) const
+{
+    size_t h = hash<double>()(k.r);
+    h = h * 1000003 ^ hash<double>()(k.sig);
+    return h * 1000003 ^ hash<double>()(k.b);
+}
+
+PerpetualExponents PerpetualAmericanBatchPricer::ExponentsOf(double r, double sig, double b)
+{ // same expressions as PerpetualAmericanPrice<>
+    double sig2 = sig*sig;
+    double fac = b/sig2 - 0.5; fac *= fac;
+    double root = sqrt(fac + 2.0*r/sig2);
+    PerpetualExponents e;
+    e.y1 = 0.5 - b/sig2 + root;
+    e.y2 = 0.5 - b/sig2 - root;
+    e.c1 = pow((e.y1 - 1.0) / e.y1, e.y1) / (e.y1 - 1.0);
+    e.c2 = pow((e.y2 - 1.0) / e.y2, e.y2) / (1.0 - e.y2);
+    e.degenerate1 = PerpetualDegenerate(Call, e.y1, r, b); // the price is S
+    e.degenerate2 = PerpetualDegenerate(Put, e.y2, r, b);
+    if (e.degenerate1) e.c1 = NAN;
+    if (e.degenerate2) e.c2 = NAN;
+    return e;
+}
+
+// Rows [i, i + count) with one vector of W lanes, count <= W. Partial blocks are padded.
+template <class V>
+SIMD_INLINE void RowBlock(const double* K, const double* S, const double* y, const double* c,
+                          const PerpetualBatchResult& out, size_t i, size_t count)
+{
+    V vK, vS, vy, vc;
+    if (count == (size_t)Lanes<V>()) {
+        vK = Load<V>(K + i); vS = Load<V>(S + i); vy = Load<V>(y + i); vc = Load<V>(c + i);
+    } else {
+        vK = vS = vc = Broadcast<V>(1.0); vy = Broadcast<V>(2.0);
+        for (size_t j = 0; j < count; j++) {
+            vK[j] = K[i + j]; vS[j] = S[i + j]; vy[j] = y[i + j]; vc[j] = c[i + j];
+        }
+    }
+
+    V price = vK * vc * Exp(vy * Log(vS / vK));
+    V delta = vy * price / vS;
+    V gamma = (vy - 1.0) * delta / vS;
+    V boundary = vK * vy / (vy - 1.0);
+
+    for (size_t j = 0; j < count; j++) {
+        if (!out.price.empty()) out.price[i + j] = price[j];
+        if (!out.delta.empty()) out.delta[i + j] = delta[j];
+        if (!out.gamma.empty()) out.gamma[i + j] = gamma[j];
+        if (!out.boundary.empty()) out.boundary[i + j] = boundary[j];
+    }
+}
+
+template <class V>
+SIMD_INLINE void RowLoop(const double* K, const double* S, const double* y, const double* c,
+                         const PerpetualBatchResult& out, size_t begin, size_t end)
+{
+    const size_t W = Lanes<V>();
+    size_t i = begin;
+    for (; i + W <= end; i += W)
+        RowBlock<V>(K, S, y, c, out, i, W);
+    if (i < end)
+        RowBlock<V>(K, S, y, c, out, i, end - i);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx512f")))
+static void RowsAvx512(const double* K, const double* S, const double* y, const double* c, const PerpetualBatchResult& out, size_t begin, size_t end)
+{
+    RowLoop<vd8>(K, S, y, c, out, begin, end);
+}
+
+__attribute__((target("avx2,fma")))
+static void RowsAvx2(const double* K, const double* S, const double* y, const double* c, const PerpetualBatchResult& out, size_t begin, size_t end)
+{
+    RowLoop<vd4>(K, S, y, c, out, begin, end);
+}
+
+__attribute__((target("sse2")))
+#endif
+static void Rows128(const double* K, const double* S, const double* y, const double* c, const PerpetualBatchResult& out, size_t begin, size_t end)
+{
+    RowLoop<vd2>(K, S, y, c, out, begin, end);
+}
+
+static void RowsScalar(const double* K, const double* S, const double* y, const double* c, const PerpetualBatchResult& out, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++) {
+        double price = K[i] * c[i] * pow(S[i] / K[i], y[i]);
+        if (!out.price.empty()) out.price[i] = price;
+        if (!out.delta.empty()) out.delta[i] = y[i] * price / S[i];
+        if (!out.gamma.empty()) out.gamma[i] = y[i] * (y[i] - 1.0) * price / (S[i] * S[i]);
+        if (!out.boundary.empty()) out.boundary[i] = K[i] * y[i] / (y[i] - 1.0);
+    }
+}
+
+PerpetualAmericanBatchPricer::PerpetualAmericanBatchPricer(): level(DetectSimdLevel()), pool(&ThreadPool::Shared()) {}
+
+PerpetualAmericanBatchPricer::PerpetualAmericanBatchPricer(SimdLevel level_, ThreadPool* pool_): level(min(level_, DetectSimdLevel())), pool(pool_) {}
+
+void PerpetualAmericanBatchPricer::ComputeRows(const double* K, const double* S, const PerpetualBatchResult& out, size_t n)
+{
+    const double* yy = y.data();
+    const double* cc = coefficient.data();
+    auto rows = [&](size_t begin, size_t end) {
+        switch (level) {
+#if defined(__x86_64__) || defined(__i386__)
+        case SimdLevel::Simd512: RowsAvx512(K, S, yy, cc, out, begin, end); break;
+        case SimdLevel::Simd256: RowsAvx2(K, S, yy, cc, out, begin, end); break;
+#endif
+        case SimdLevel::Simd128: Rows128(K, S, yy, cc, out, begin, end); break;
+        default: RowsScalar(K, S, yy, cc, out, begin, end);
+        }
+    };
+    if (pool == nullptr || n < ParallelThreshold)
+        rows(0, n);
+    else
+        pool->ParallelFor(n, ChunkSize, rows);
+
+    for (size_t i = 0; i < n; i++) { // degenerate exponents, as in PerpetualAmericanOption::Price()
+        if (degenerate[i]) {
+            if (!out.price.empty()) out.price[i] = S[i];
+            if (!out.delta.empty()) out.delta[i] = 1.0;
+            if (!out.gamma.empty()) out.gamma[i] = 0.0;
+            if (!out.boundary.empty()) out.boundary[i] = y[i] == 0.0 ? 0.0 : INFINITY; // put y2 == 0, call y1 at 1
+        }
+    }
+}
+
+void PerpetualAmericanBatchPricer::Compute(const PerpetualBatch& in, const PerpetualBatchResult& out)
+{
+    size_t n = in.size();
+    if (in.K.size() != n || in.sig.size() != n || in.r.size() != n || in.b.size() != n
+        || (!in.type.empty() && in.type.size() != n))
+        throw invalid_argument("PerpetualAmericanBatchPricer: input columns differ in length");
+    for (span<double> column: {out.price, out.delta, out.gamma, out.boundary})
+        if (!column.empty() && column.size() != n)
+            throw invalid_argument("PerpetualAmericanBatchPricer: output column does not match batch size");
+    metrics::count(metrics::Engine::PerpetualBatch, metrics::Counter::OptionsPriced, n);
+
+    {
+        metrics::ScopedTimer timer(metrics::Engine::PerpetualBatch, metrics::Phase::Setup);
+        y.resize(n);
+        coefficient.resize(n);
+        degenerate.resize(n);
+        groups.clear();
+        Key last{NAN, NAN, NAN};
+        const PerpetualExponents* e = nullptr;
+        for (size_t i = 0; i < n; i++) {
+            Key key{in.r[i], in.sig[i], in.b[i]};
+            if (!(key == last)) { // runs of one group skip the hash lookup
+                auto it = groups.find(key);
+                if (it == groups.end())
+                    it = groups.emplace(key, ExponentsOf(key.r, key.sig, key.b)).first;
+                e = &it->second;
+                last = key;
+            }
+            OptionType type = in.type.empty() ? in.allType : in.type[i];
+            y[i] = type == Call ? e->y1 : e->y2;
+            coefficient[i] = type == Call ? e->c1 : e->c2;
+            degenerate[i] = type == Call ? e->degenerate1 : e->degenerate2;
+        }
+    }
+    metrics::ScopedTimer timer(metrics::Engine::PerpetualBatch, metrics::Phase::Kernel);
+    ComputeRows(in.K.data(), in.S.data(), out, n);
+}
+
+void PerpetualAmericanBatchPricer::SpotLadder(const OptionParameters& p, span<const double> S, const PerpetualBatchResult& out)
+{
+    size_t n = S.size();
+    for (span<double> column: {out.price, out.delta, out.gamma, out.boundary})
+        if (!column.empty() && column.size() != n)
+            throw invalid_argument("PerpetualAmericanBatchPricer: output column does not match ladder size");
+
+    metrics::count(metrics::Engine::PerpetualBatch, metrics::Counter::OptionsPriced, n);
+    metrics::ScopedTimer timer(metrics::Engine::PerpetualBatch, metrics::Phase::Kernel);
+    PerpetualExponents e = ExponentsOf(p.r, p.sig, p.b);
+    y.assign(n, p.type == Call ? e.y1 : e.y2);
+    coefficient.assign(n, p.type == Call ? e.c1 : e.c2);
+    degenerate.assign(n, p.type == Call ? e.degenerate1 : e.degenerate2);
+    strike.assign(n, p.K);
+    ComputeRows(strike.data(), S.data(), out, n);
+}
+
+PerpetualColumns::PerpetualColumns(const vector<vector<double>>& parameter_matrix, OptionType opt_type)
+    : data(5 * parameter_matrix.size()), type(opt_type), n(parameter_matrix.size())
+{ // transpose once, rows are read by reference
+    for (size_t i = 0; i < n; i++) {
+        const vector<double>& row = parameter_matrix[i];
+        for (size_t j = 0; j < 5; j++)
+            data[j * n + i] = row[j];
+    }
+}
+
+PerpetualBatch PerpetualColumns::Batch() const
+{
+    span<const double> all(data);
+    return PerpetualBatch{ all.subspan(0, n), all.subspan(n, n), all.subspan(2 * n, n),
+                           all.subspan(3 * n, n), all.subspan(4 * n, n), {}, type };
+}
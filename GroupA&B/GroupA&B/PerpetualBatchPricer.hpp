@@ -0,0 +1,101 @@
+//
+//  PerpetualBatchPricer.hpp
+//  GroupA&B
+//  Batch pricer for perpetual American options with cached exponents
+//  Created by Kevin on 10/18/26.
+//
+//  The perpetual price is V = A * S^y with the exponent y (y1 for calls, y2 for
+//  puts) depending on (r, sig, b) only. Rows are grouped by (r, sig, b), y and
+//  the strike-free coefficient are computed once per group, and every row then
+//  costs one log and one exp in the SIMD kernel:
+//      V = K * c * (S/K)^y,  c = ((y-1)/y)^y / (w (y-1)),  w = +1 call, -1 put
+//      delta = y V / S,  gamma = y (y-1) V / S^2,  exercise boundary S* = K y / (y-1)
+//  Like PerpetualAmericanOption::Price(), rows past the boundary get the
+//  continuation formula; compare S with the boundary to find them. Rows at the
+//  pole (PerpetualDegenerate(), the test Price() uses) price at S with delta 1,
+//  gamma 0 and no exercise: the call boundary is +inf, the put boundary 0.
+//
+
+#ifndef PerpetualBatchPricer_hpp
+#define PerpetualBatchPricer_hpp
+
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include "Option.hpp"
+#include "SimdMath.hpp"
+#include "ThreadPool.hpp"
+
+using namespace std;
+
+// Contiguous input columns, one entry per option
+struct PerpetualBatch {
+    span<const double> K;   // strike price
+    span<const double> sig; // volatility
+    span<const double> r;   // risk-free interest rate
+    span<const double> b;   // cost of carry
+    span<const double> S;   // asset price
+    span<const OptionType> type; // per-row type, empty for a homogeneous batch
+    OptionType allType = Call;    // type of every row when the type column is empty
+
+    size_t size() const { return S.size(); }
+};
+
+// Caller-owned output columns. An empty span means "do not compute".
+struct PerpetualBatchResult {
+    span<double> price;
+    span<double> delta;
+    span<double> gamma;
+    span<double> boundary; // optimal exercise level S*
+};
+
+// Cached quantities of one (r, sig, b) group
+struct PerpetualExponents {
+    double y1, y2; // call and put exponents
+    double c1, c2; // call and put coefficients ((y-1)/y)^y / (w (y-1)), NaN when degenerate
+    bool degenerate1, degenerate2; // call and put exponent at the pole, see PerpetualDegenerate()
+};
+
+class PerpetualAmericanBatchPricer {
+private:
+    struct Key {
+        double r, sig, b;
+        bool operator == (const Key& k) const { return r == k.r && sig == k.sig && b == k.b; }
+    };
+    struct KeyHash { size_t operator () (const Key& k) const; };
+
+    simd::SimdLevel level;
+    ThreadPool* pool;
+    unordered_map<Key, PerpetualExponents, KeyHash> groups; // cleared per call, keeps its buckets
+    vector<double> y, coefficient, strike;         // per-row scratch
+    vector<unsigned char> degenerate;              // per-row scratch, 1 at the pole
+
+    void ComputeRows(const double* K, const double* S, const PerpetualBatchResult& result, size_t n);
+
+public:
+    static const size_t ParallelThreshold = 16384;
+    static const size_t ChunkSize = 4096;
+
+    PerpetualAmericanBatchPricer(); // widest kernel the cpu supports, shared thread pool
+    PerpetualAmericanBatchPricer(simd::SimdLevel level, ThreadPool* pool = &ThreadPool::Shared());
+
+    static PerpetualExponents ExponentsOf(double r, double sig, double b);
+
+    // Price the batch; scratch is reused, so use one pricer per thread
+    void Compute(const PerpetualBatch& batch, const PerpetualBatchResult& result);
+
+    // Spot ladder for one contract, the exponent is computed once
+    void SpotLadder(const OptionParameters& p, span<const double> S, const PerpetualBatchResult& result);
+};
+
+// Column buffer for a row-major parameter matrix {K, sig, r, b, S}
+struct PerpetualColumns {
+    vector<double> data; // 5 contiguous columns of n rows
+    OptionType type;
+    size_t n = 0;
+
+    PerpetualColumns(const vector<vector<double>>& parameter_matrix, OptionType opt_type);
+    PerpetualBatch Batch() const;
+};
+
+#endif /* PerpetualBatchPricer_hpp */
@@ -0,0 +1,207 @@
+//
+//  Portfolio.cpp
+//  GroupA&B
+//  Portfolio implementation
+//  Created by Kevin on 10/18/26.
+//
+
+#include "Portfolio.hpp"
+#include "BlackScholes.hpp"
+#include "PerpetualAmericanOptions.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+static const double VegaBump = 1e-4; // perpetual vega is a central difference, the rest is analytic
+
+// Value and sensitivities of one unit of the option
+static RiskFigures UnitRisk(const Position& position)
+{
+    const OptionParameters& p = position.p;
+    const double w = p.type; // +1 call, -1 put
+    RiskFigures f;
+    if (position.model == PricingModel::European && p.T == 0.0) { // expired, the payoff as in ScenarioGrid
+        double intrinsic = w * (p.S - p.K);
+        f.pv = max(intrinsic, 0.0);
+        f.delta = intrinsic > 0.0 ? w : 0.0;
+    } else if (position.model == PricingModel::European) { // the position's own type only
+        double sqrtT = sqrt(p.T), vol = p.sig * sqrtT;
+        double d1 = (log(p.S / p.K) + (p.b + 0.5 * p.sig * p.sig) * p.T) / vol;
+        double carry = p.S * exp((p.b - p.r) * p.T); // discounted forward
+        boost::math::normal_distribution<> normalDist(0, 1);
+        double Nd1 = cdf(normalDist, w * d1), nd1 = pdf(normalDist, d1);
+        f.pv = w * (carry * Nd1 - p.K * exp(-p.r * p.T) * cdf(normalDist, w * (d1 - vol)));
+        f.delta = w * carry / p.S * Nd1;
+        f.gamma = nd1 * carry / (p.S * p.S * vol);
+        f.vega = carry * nd1 * sqrtT;
+    } else {
+        PerpetualAmericanOption option(p.K, p.sig, p.r, p.b, p.S, p.type);
+        const PerpetualInvariants& inv = option.Invariants();
+        f.pv = option.PriceAt(p.S);
+        f.delta = inv.degenerate ? 1.0 : inv.y * f.pv / p.S; // price is scale (ratio S)^y
+        f.gamma = inv.degenerate ? 0.0 : (inv.y - 1.0) * f.delta / p.S;
+        OptionParameters up = p, down = p;
+        up.sig += VegaBump;
+        down.sig -= VegaBump;
+        f.vega = (PerpetualAmericanOption::PriceOf(up) - PerpetualAmericanOption::PriceOf(down)) / (2 * VegaBump);
+    }
+    return f;
+}
+
+Portfolio::Portfolio(vector<double> expiryEdges, ThreadPool* pool_): edges(move(expiryEdges)), pool(pool_)
+{
+    for (size_t i = 1; i < edges.size(); i++)
+        if (!(edges[i - 1] < edges[i]))
+            throw invalid_argument("Portfolio: expiry edges must be strictly ascending");
+}
+
+size_t Portfolio::ExpiryBucket(double T) const
+{
+    return lower_bound(edges.begin(), edges.end(), T) - edges.begin();
+}
+
+size_t Portfolio::UnderlyingId(const string& name)
+{
+    auto it = underlyingIds.find(name);
+    if (it != underlyingIds.end())
+        return it->second;
+    underlyingIds.emplace(name, underlyings.size());
+    underlyings.push_back(name);
+    members.emplace_back();
+    bucketRisk.resize(underlyings.size() * ExpiryBuckets());
+    bucketCount.resize(underlyings.size() * ExpiryBuckets());
+    return underlyings.size() - 1;
+}
+
+size_t Portfolio::BucketOf(size_t underlying, const Position& position) const
+{
+    size_t expiry = position.model == PricingModel::European ? ExpiryBucket(position.p.T) : PerpetualBucket();
+    return underlying * ExpiryBuckets() + expiry;
+}
+
+void Portfolio::Validate(const Position& position)
+{
+    if (!(position.p.sig > 0.0))
+        throw invalid_argument("Portfolio: the volatility of a position must be positive");
+    if (position.model == PricingModel::European && !(position.p.T >= 0.0))
+        throw invalid_argument("Portfolio: the time to expiry of a European position is negative");
+}
+
+size_t Portfolio::Add(const Position& position)
+{
+    Validate(position);
+    size_t id = positions.size();
+    size_t underlying = UnderlyingId(position.underlying);
+    positions.push_back(position);
+    figures.emplace_back();
+    bucketOf.push_back(BucketOf(underlying, position));
+    if (position.quantity != 0.0)
+        bucketCount[bucketOf.back()]++;
+    members[underlying].push_back(id);
+    if (id / BlockSize >= blocks.size())
+        blocks.emplace_back();
+    blocks[id / BlockSize].stale = true;
+    return id;
+}
+
+void Portfolio::Update(size_t id, const Position& position)
+{
+    if (id >= positions.size())
+        throw out_of_range("Portfolio: no position with this id");
+    Validate(position);
+    size_t underlying = UnderlyingId(position.underlying);
+    if (position.underlying != positions[id].underlying) {
+        vector<size_t>& old = members[underlyingIds.at(positions[id].underlying)];
+        old.erase(find(old.begin(), old.end(), id));
+        vector<size_t>& now = members[underlying];
+        now.insert(lower_bound(now.begin(), now.end(), id), id);
+    }
+    if (positions[id].quantity != 0.0)
+        bucketCount[bucketOf[id]]--;
+    positions[id] = position;
+    bucketOf[id] = BucketOf(underlying, position);
+    if (position.quantity != 0.0)
+        bucketCount[bucketOf[id]]++;
+    blocks[id / BlockSize].stale = true;
+}
+
+void Portfolio::SetSpot(const string& underlying, double S)
+{
+    auto it = underlyingIds.find(underlying);
+    if (it == underlyingIds.end())
+        return;
+    for (size_t id : members[it->second]) {
+        positions[id].p.S = S;
+        blocks[id / BlockSize].stale = true;
+    }
+}
+
+void Portfolio::RevalueBlock(size_t b)
+{ // serial and in position order, so the sums do not depend on the thread
+    Block& block = blocks[b];
+    size_t begin = b * BlockSize, end = min(positions.size(), begin + BlockSize);
+    vector<pair<size_t, size_t>> order; // (bucket, position)
+    order.reserve(end - begin);
+    block.total = RiskFigures();
+    for (size_t i = begin; i < end; i++) {
+        RiskFigures unit = UnitRisk(positions[i]);
+        double q = positions[i].quantity;
+        figures[i] = RiskFigures{q * unit.pv, q * unit.delta, q * unit.gamma, q * unit.vega};
+        block.total += figures[i];
+        order.emplace_back(bucketOf[i], i);
+    }
+    sort(order.begin(), order.end());
+    block.buckets.clear();
+    for (const pair<size_t, size_t>& entry : order) {
+        if (block.buckets.empty() || block.buckets.back().first != entry.first)
+            block.buckets.emplace_back(entry.first, RiskFigures());
+        block.buckets.back().second += figures[entry.second];
+    }
+    block.stale = false;
+}
+
+void Portfolio::Revalue()
+{
+    vector<size_t> stale;
+    for (size_t b = 0; b < blocks.size(); b++)
+        if (blocks[b].stale)
+            stale.push_back(b);
+
+    auto body = [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; k++)
+            RevalueBlock(stale[k]);
+    };
+    if (pool == nullptr || stale.size() < 2)
+        body(0, stale.size());
+    else
+        pool->ParallelFor(stale.size(), 1, body);
+
+    // fixed order reduction over the block figures
+    total = RiskFigures();
+    fill(bucketRisk.begin(), bucketRisk.end(), RiskFigures());
+    for (const Block& block : blocks) {
+        total += block.total;
+        for (const pair<size_t, RiskFigures>& entry : block.buckets)
+            bucketRisk[entry.first] += entry.second;
+    }
+}
+
+RiskFigures Portfolio::Bucket(const string& underlying, size_t expiry) const
+{
+    auto it = underlyingIds.find(underlying);
+    if (it == underlyingIds.end() || expiry >= ExpiryBuckets())
+        return RiskFigures();
+    return bucketRisk[it->second * ExpiryBuckets() + expiry];
+}
+
+vector<BucketRisk> Portfolio::Buckets() const
+{
+    vector<BucketRisk> out;
+    for (const pair<const string, size_t>& underlying : underlyingIds)
+        for (size_t expiry = 0; expiry < ExpiryBuckets(); expiry++) {
+            size_t bucket = underlying.second * ExpiryBuckets() + expiry;
+            if (bucketCount[bucket] > 0)
+                out.push_back(BucketRisk{underlying.first, expiry, bucketRisk[bucket]});
+        }
+    return out;
+}
@@ -0,0 +1,111 @@
+//
+//  Portfolio.hpp
+//  GroupA&B
+//  Book of European and perpetual American positions with aggregated risk
+//  Created by Kevin on 10/18/26.
+//
+//  Positions are kept in blocks of BlockSize. Revalue() prices only the
+//  blocks touched since the last call, in parallel, and sums each block in
+//  position order into a block total and per-bucket partials. The book
+//  figures are then the block figures added in block order. No sum depends
+//  on which thread priced a block, and an update followed by Revalue() gives
+//  bitwise the figures of a freshly built book. A tick costs one block and
+//  one pass over the block partials, not the whole book. SetSpot() touches
+//  every block holding the underlying, so add positions grouped by underlying.
+//
+//  Buckets are (underlying, expiry): expiry bucket i < edges.size() holds
+//  T <= edges[i] above the previous edge, bucket edges.size() everything
+//  longer, and PerpetualBucket() the perpetual positions.
+//
+
+#ifndef Portfolio_hpp
+#define Portfolio_hpp
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Option.hpp"
+#include "ThreadPool.hpp"
+
+using namespace std;
+
+// Quantity-weighted value and sensitivities
+struct RiskFigures {
+    double pv = 0.0;
+    double delta = 0.0; // dV/dS
+    double gamma = 0.0; // d2V/dS2
+    double vega = 0.0;  // dV/dsig
+
+    RiskFigures& operator += (const RiskFigures& f)
+    {
+        pv += f.pv; delta += f.delta; gamma += f.gamma; vega += f.vega;
+        return *this;
+    }
+};
+
+struct Position {
+    string underlying;
+    OptionParameters p;
+    PricingModel model = PricingModel::European;
+    double quantity = 1.0;
+};
+
+struct BucketRisk {
+    string underlying;
+    size_t expiry; // expiry bucket, see Portfolio
+    RiskFigures risk;
+};
+
+class Portfolio {
+private:
+    struct Block {
+        RiskFigures total;
+        vector<pair<size_t, RiskFigures>> buckets; // ascending bucket index, non-empty buckets only
+        bool stale = true;
+    };
+
+    vector<double> edges;           // expiry bucket edges, ascending
+    ThreadPool* pool;               // nullptr keeps everything on the calling thread
+    vector<Position> positions;
+    vector<RiskFigures> figures;    // per position, as of the last Revalue()
+    vector<size_t> bucketOf;        // per position
+    vector<Block> blocks;
+    map<string, size_t> underlyingIds;
+    vector<string> underlyings;     // by id
+    vector<vector<size_t>> members; // positions by underlying id
+    vector<RiskFigures> bucketRisk; // underlying id * ExpiryBuckets() + expiry
+    vector<size_t> bucketCount;     // positions with a non-zero quantity per bucket
+    RiskFigures total;
+
+    size_t UnderlyingId(const string& name);
+    size_t BucketOf(size_t underlying, const Position& position) const;
+    static void Validate(const Position& position); // throws invalid_argument, see Add()
+    void RevalueBlock(size_t block);
+
+public:
+    static const size_t BlockSize = 256;
+
+    explicit Portfolio(vector<double> expiryEdges = {0.25, 0.5, 1.0, 2.0, 5.0}, ThreadPool* pool = &ThreadPool::Shared());
+
+    // Both throw invalid_argument for sig <= 0 or a European T < 0; a European position at T = 0 is worth its payoff
+    size_t Add(const Position& position); // returns the id of the position
+    void Update(size_t id, const Position& position); // replace, quantity 0 takes it out of the figures
+    void SetSpot(const string& underlying, double S); // move every position on the underlying
+    const Position& operator [] (size_t id) const { return positions.at(id); }
+    size_t Size() const { return positions.size(); }
+
+    // Price the changed blocks and rebuild the book figures, the getters below read the last result
+    void Revalue();
+
+    const RiskFigures& Total() const { return total; }
+    const RiskFigures& Risk(size_t id) const { return figures.at(id); }
+    RiskFigures Bucket(const string& underlying, size_t expiry) const; // zero for an unknown bucket
+    vector<BucketRisk> Buckets() const; // buckets with a non-zero quantity by underlying name, then expiry
+
+    size_t ExpiryBuckets() const { return edges.size() + 2; }
+    size_t PerpetualBucket() const { return edges.size() + 1; }
+    size_t ExpiryBucket(double T) const;
+};
+
+#endif /* Portfolio_hpp */
@@ -0,0 +1,143 @@
+//
+//  PricingCache.cpp
+//  GroupA&B
+//  Sharded CLOCK cache of closed-form prices
+//  Created by Kevin on 10/18/26.
+//
+
+#include "PricingCache.hpp"
+#include <cmath>
+#include <cstring>
+
+static uint64_t Bits(double x)
+{ // -0.0 and 0.0 compare equal, so they must hash alike
+    if (x == 0.0)
+        x = 0.0;
+    uint64_t u;
+    memcpy(&u, &x, sizeof(u));
+    return u;
+}
+
+static uint64_t Mix(uint64_t h, uint64_t x)
+{ // splitmix64 finaliser over the running hash
+    h ^= x + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+
+static double Snap(double x, double step) { return step > 0.0 ? step * nearbyint(x / step) : x; }
+
+size_t PricingCache::KeyHash::operator () (const Key& k) const
+{
+    uint64_t h = uint64_t(k.model) << 8 | uint64_t(k.type == Call);
+    for (double x: {k.T, k.K, k.sig, k.r, k.b, k.S})
+        h = Mix(h, Bits(x));
+    return size_t(h);
+}
+
+PricingCache::PricingCache(size_t capacity, CacheQuantization quantization)
+    : shardCapacity(max<size_t>(1, (capacity + Shards - 1) / Shards)), quantum(quantization)
+{
+    for (size_t i = 0; i < Shards; i++) {
+        shards.emplace_back(new Shard);
+        shards.back()->index.reserve(shardCapacity);
+    }
+}
+
+OptionParameters PricingCache::Quantize(PricingModel model, const OptionParameters& p) const
+{
+    OptionParameters q;
+    q.T = model == PricingModel::PerpetualAmerican ? 0.0 : Snap(p.T, quantum.T);
+    q.K = Snap(p.K, quantum.K);
+    q.sig = Snap(p.sig, quantum.sig);
+    q.r = Snap(p.r, quantum.r);
+    q.b = Snap(p.b, quantum.b);
+    q.S = Snap(p.S, quantum.S);
+    q.type = p.type;
+    return q;
+}
+
+PricingCache::Key PricingCache::MakeKey(PricingModel model, const OptionParameters& p) const
+{
+    OptionParameters q = Quantize(model, p);
+    return Key{q.T, q.K, q.sig, q.r, q.b, q.S, q.type, model};
+}
+
+bool PricingCache::Find(PricingModel model, const OptionParameters& p, double& value)
+{
+    Key key = MakeKey(model, p);
+    size_t hash = KeyHash()(key);
+    Shard& shard = ShardOf(hash);
+    {
+        lock_guard<mutex> guard(shard.lock);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            Slot& slot = shard.slots[it->second];
+            slot.referenced = true;
+            value = slot.value;
+            hits.fetch_add(1, memory_order_relaxed);
+            return true;
+        }
+    }
+    misses.fetch_add(1, memory_order_relaxed);
+    return false;
+}
+
+void PricingCache::Insert(PricingModel model, const OptionParameters& p, double value)
+{
+    Key key = MakeKey(model, p);
+    size_t hash = KeyHash()(key);
+    Shard& shard = ShardOf(hash);
+    lock_guard<mutex> guard(shard.lock);
+
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) { // another thread computed it meanwhile
+        shard.slots[it->second].value = value;
+        return;
+    }
+    if (shard.slots.size() < shardCapacity) {
+        shard.index.emplace(key, shard.slots.size());
+        shard.slots.push_back(Slot{key, value, false});
+        return;
+    }
+
+    // CLOCK: give referenced slots a second chance, replace the first cold one
+    while (shard.slots[shard.hand].referenced) {
+        shard.slots[shard.hand].referenced = false;
+        shard.hand = (shard.hand + 1) % shard.slots.size();
+    }
+    Slot& victim = shard.slots[shard.hand];
+    shard.index.erase(victim.key);
+    victim = Slot{key, value, false};
+    shard.index.emplace(key, shard.hand);
+    shard.hand = (shard.hand + 1) % shard.slots.size();
+    evictions.fetch_add(1, memory_order_relaxed);
+}
+
+PricingCacheStats PricingCache::Stats() const
+{
+    PricingCacheStats s;
+    s.hits = hits.load(memory_order_relaxed);
+    s.misses = misses.load(memory_order_relaxed);
+    s.evictions = evictions.load(memory_order_relaxed);
+    s.capacity = shardCapacity * shards.size();
+    for (const unique_ptr<Shard>& shard: shards) {
+        lock_guard<mutex> guard(shard->lock);
+        s.size += shard->slots.size();
+    }
+    return s;
+}
+
+void PricingCache::Clear()
+{
+    for (const unique_ptr<Shard>& shard: shards) {
+        lock_guard<mutex> guard(shard->lock);
+        shard->slots.clear();
+        shard->index.clear();
+        shard->hand = 0;
+    }
+    hits.store(0, memory_order_relaxed);
+    misses.store(0, memory_order_relaxed);
+    evictions.store(0, memory_order_relaxed);
+}
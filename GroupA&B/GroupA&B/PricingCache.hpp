@@ -0,0 +1,125 @@
+//
+//  PricingCache.hpp
+//  GroupA&B
+//  Bounded, thread-safe memo of closed-form prices keyed on the parameter block
+//  Created by Kevin on 10/18/26.
+//
+//  The key is (model, T, K, sig, r, b, S, type), T is dropped for perpetual
+//  options. With a CacheQuantization each field is snapped to its grid before
+//  the lookup and the price is computed at the snapped point, so a cached
+//  value depends only on the grid cell and not on which quote came first.
+//  The default quantization is exact. A spot step coarser than the bump of
+//  the difference greeks folds the bumped prices into one cell, so quantize
+//  S only where those greeks are not needed.
+//
+//  Entries live in Shards independent shards, each a fixed slot array with a
+//  hash index and CLOCK eviction: a hit sets the slot's reference bit, an
+//  insert into a full shard sweeps the hand, clearing bits, until it finds an
+//  unreferenced slot. One mutex per shard; statistics are relaxed atomics.
+//
+
+#ifndef PricingCache_hpp
+#define PricingCache_hpp
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "Option.hpp"
+
+using namespace std;
+
+// Absolute grid step of each field, 0 keeps the exact value
+struct CacheQuantization {
+    double T = 0.0;
+    double K = 0.0;
+    double sig = 0.0;
+    double r = 0.0;
+    double b = 0.0;
+    double S = 0.0;
+};
+
+struct PricingCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t size = 0;     // entries held
+    size_t capacity = 0;
+
+    double HitRate() const { return hits + misses > 0 ? double(hits) / double(hits + misses) : 0.0; }
+};
+
+class PricingCache {
+private:
+    struct Key {
+        double T, K, sig, r, b, S;
+        OptionType type;
+        PricingModel model;
+        bool operator == (const Key& k) const
+        {
+            return T == k.T && K == k.K && sig == k.sig && r == k.r && b == k.b && S == k.S
+                && type == k.type && model == k.model;
+        }
+    };
+    struct KeyHash { size_t operator () (const Key& k) const; };
+
+    struct Slot {
+        Key key;
+        double value;
+        bool referenced; // CLOCK bit, set on every hit
+    };
+
+    struct Shard {
+        mutex lock;
+        vector<Slot> slots; // grows to the shard capacity, then entries are replaced
+        unordered_map<Key, size_t, KeyHash> index;
+        size_t hand = 0;
+    };
+
+    vector<unique_ptr<Shard>> shards;
+    size_t shardCapacity;
+    CacheQuantization quantum;
+    atomic<uint64_t> hits{0}, misses{0}, evictions{0};
+
+    Key MakeKey(PricingModel model, const OptionParameters& p) const;
+    Shard& ShardOf(size_t hash) const { return *shards[(hash >> 48) % shards.size()]; }
+
+public:
+    static const size_t Shards = 16;
+
+    explicit PricingCache(size_t capacity = 65536, CacheQuantization quantization = CacheQuantization());
+
+    // The parameter block the cache prices for p: p snapped to the grid, T = 0 for perpetual options
+    OptionParameters Quantize(PricingModel model, const OptionParameters& p) const;
+
+    bool Find(PricingModel model, const OptionParameters& p, double& value);
+    void Insert(PricingModel model, const OptionParameters& p, double value);
+
+    // Cached price of p, compute(const OptionParameters&) runs on the quantized block on a miss
+    template <class F>
+    double GetOrCompute(PricingModel model, const OptionParameters& p, F compute)
+    {
+        double value;
+        if (Find(model, p, value))
+            return value;
+        value = compute(Quantize(model, p));
+        Insert(model, p, value);
+        return value;
+    }
+
+    PricingCacheStats Stats() const;
+    void Clear(); // drops the entries and the statistics
+};
+
+// Pricer adapter for FiniteDifferenceGreeks: Pricer behind a cache, bumped
+// revaluations that repeat (the unbumped price in Gamma) hit the cache
+template <class Pricer, PricingModel Model>
+struct CachedPricer {
+    PricingCache* cache;
+    Pricer pricer;
+    double operator () (const OptionParameters& p) const { return cache->GetOrCompute(Model, p, pricer); }
+};
+
+#endif /* PricingCache_hpp */
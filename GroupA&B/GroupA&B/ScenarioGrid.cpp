@@ -0,0 +1,298 @@
+//
+//  ScenarioGrid.cpp
+//  GroupA&B
+//  Scenario grid engine implementation
+//  Created by Kevin on 10/18/26.
+//
+
+#include "ScenarioGrid.hpp"
+#include "PerpetualAmericanOptions.hpp"
+#include "Metrics.hpp"
+#include <cmath>
+#include <stdexcept>
+#include <boost/math/distributions/normal.hpp>
+
+using namespace boost::math;
+using namespace simd;
+
+namespace {
+
+struct OptionNode { // per option
+    double base;    // spot the spot axis applies to, 1 for absolute levels
+    double logBase;
+    double logK;
+};
+
+struct TimeNode {   // per option and time node, European options only
+    double T;
+    double sqrtT;
+    double carry;   // e^{(b-r)T}
+    double disc;    // K e^{-rT}
+};
+
+// What stays fixed along one line. At spot node i with axis value x_i,
+//   S = base x_i  and  u = log x_i + shift
+// European:  shift = log base - log K + drift, d1 = u / vol
+// Perpetual: shift = log(ratio base), price = scale e^{y u}
+// A European line at T = 0 is the payoff, with delta 0 at the strike.
+struct LineParams {
+    PricingModel model;
+    double w;       // +1 call, -1 put
+    double base;
+    double shift;
+    bool expired;                    // European at T = 0
+    double vol, invVol, carry, disc; // European
+    double y, scale;                 // perpetual
+    bool degenerate;                 // perpetual with y at the pole, the price is S
+};
+
+}
+
+static double AxisValue(const ScenarioAxis& axis, size_t i, double own)
+{
+    if (axis.values.empty())
+        return own;
+    return axis.kind == AxisKind::Absolute ? axis.values[i] : own + axis.values[i];
+}
+
+// Scalar reference path
+static void LineScalar(const LineParams& L, const double* x, const double* logx, size_t n,
+                       double* price, double* delta, double* gamma)
+{
+    normal_distribution<> normalDist(0, 1);
+    for (size_t i = 0; i < n; i++) {
+        double S = L.base * x[i], u = logx[i] + L.shift, p, d, g;
+        if (L.expired) {
+            double intrinsic = L.w * (S - L.disc);
+            p = max(intrinsic, 0.0); d = intrinsic > 0.0 ? L.w : 0.0; g = 0.0;
+        } else if (L.model == PricingModel::European) {
+            double d1 = u * L.invVol;
+            double Nd1 = cdf(normalDist, L.w * d1);
+            p = L.w * (S * L.carry * Nd1 - L.disc * cdf(normalDist, L.w * (d1 - L.vol)));
+            d = L.w * L.carry * Nd1;
+            g = pdf(normalDist, d1) * L.carry / (S * L.vol);
+        } else if (L.degenerate) {
+            p = S; d = 1.0; g = 0.0;
+        } else {
+            p = L.scale * exp(L.y * u);
+            d = L.y * p / S;
+            g = (L.y - 1.0) * d / S;
+        }
+        if (price) price[i] = p;
+        if (delta) delta[i] = d;
+        if (gamma) gamma[i] = g;
+    }
+}
+
+// Spot nodes [0, count) of a line with one vector of W lanes, count <= W. Partial blocks are padded.
+template <class V>
+SIMD_INLINE void LineBlock(const LineParams& L, const double* x, const double* logx, size_t count,
+                           double* price, double* delta, double* gamma)
+{
+    const int W = Lanes<V>();
+    V xs, u;
+    if (count == (size_t)W) {
+        xs = Load<V>(x); u = Load<V>(logx);
+    } else {
+        xs = Broadcast<V>(1.0); u = V{};
+        for (size_t j = 0; j < count; j++) {
+            xs[j] = x[j]; u[j] = logx[j];
+        }
+    }
+    V S = xs * L.base;
+    u = u + L.shift;
+
+    V p, d, g;
+    if (L.model == PricingModel::European) {
+        V d1 = u * L.invVol;
+        V pdf;
+        V Nd1 = NormalCdf(L.w * d1, pdf);
+        p = L.w * (S * L.carry * Nd1 - L.disc * NormalCdf(L.w * (d1 - L.vol)));
+        d = L.w * L.carry * Nd1;
+        g = pdf * L.carry / (S * L.vol);
+    } else if (L.degenerate) {
+        p = S; d = Broadcast<V>(1.0); g = V{};
+    } else {
+        p = L.scale * Exp(L.y * u);
+        d = L.y * p / S;
+        g = (L.y - 1.0) * d / S;
+    }
+
+    for (size_t j = 0; j < count; j++) { // the compiler turns full blocks into vector stores
+        if (price) price[j] = p[j];
+        if (delta) delta[j] = d[j];
+        if (gamma) gamma[j] = g[j];
+    }
+}
+
+template <class V>
+SIMD_INLINE void LineVector(const LineParams& L, const double* x, const double* logx, size_t n,
+                            double* price, double* delta, double* gamma)
+{
+    const size_t W = Lanes<V>();
+    size_t i = 0;
+    for (; i + W <= n; i += W)
+        LineBlock<V>(L, x + i, logx + i, W, price ? price + i : nullptr, delta ? delta + i : nullptr,
+                     gamma ? gamma + i : nullptr);
+    if (i < n)
+        LineBlock<V>(L, x + i, logx + i, n - i, price ? price + i : nullptr, delta ? delta + i : nullptr,
+                     gamma ? gamma + i : nullptr);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx512f")))
+static void LineAvx512(const LineParams& L, const double* x, const double* logx, size_t n, double* price, double* delta, double* gamma)
+{
+    LineVector<vd8>(L, x, logx, n, price, delta, gamma);
+}
+
+__attribute__((target("avx2,fma")))
+static void LineAvx2(const LineParams& L, const double* x, const double* logx, size_t n, double* price, double* delta, double* gamma)
+{
+    LineVector<vd4>(L, x, logx, n, price, delta, gamma);
+}
+
+__attribute__((target("sse2")))
+static void Line128(const LineParams& L, const double* x, const double* logx, size_t n, double* price, double* delta, double* gamma)
+{
+    LineVector<vd2>(L, x, logx, n, price, delta, gamma);
+}
+#else
+static void Line128(const LineParams& L, const double* x, const double* logx, size_t n, double* price, double* delta, double* gamma)
+{
+    LineVector<vd2>(L, x, logx, n, price, delta, gamma);
+}
+#endif
+
+static void ComputeLine(SimdLevel level, const LineParams& L, const double* x, const double* logx, size_t n,
+                        double* price, double* delta, double* gamma)
+{
+    if (L.expired) { // payoff lines are rare, no vector kernel
+        LineScalar(L, x, logx, n, price, delta, gamma);
+        return;
+    }
+    switch (level) {
+#if defined(__x86_64__) || defined(__i386__)
+    case SimdLevel::Simd512: LineAvx512(L, x, logx, n, price, delta, gamma); break;
+    case SimdLevel::Simd256: LineAvx2(L, x, logx, n, price, delta, gamma); break;
+#endif
+    case SimdLevel::Simd128: Line128(L, x, logx, n, price, delta, gamma); break;
+    default: LineScalar(L, x, logx, n, price, delta, gamma);
+    }
+}
+
+ScenarioGridEngine::ScenarioGridEngine(): level(DetectSimdLevel()), pool(&ThreadPool::Shared()) {}
+
+ScenarioGridEngine::ScenarioGridEngine(SimdLevel level_, ThreadPool* pool_): level(min(level_, DetectSimdLevel())), pool(pool_) {}
+
+void ScenarioGridEngine::Compute(const vector<ScenarioOption>& options, const ScenarioAxes& axes, const ScenarioResult& result) const
+{
+    size_t total = options.size() * axes.Points();
+    if ((!result.price.empty() && result.price.size() != total) || (!result.delta.empty() && result.delta.size() != total)
+        || (!result.gamma.empty() && result.gamma.size() != total))
+        throw invalid_argument("ScenarioGridEngine: output column does not match grid size");
+    Run(options, axes, &result, nullptr, false);
+}
+
+void ScenarioGridEngine::Compute(const vector<ScenarioOption>& options, const ScenarioAxes& axes, const ScenarioSink& sink,
+                                 bool greeks) const
+{
+    Run(options, axes, nullptr, &sink, greeks);
+}
+
+void ScenarioGridEngine::Run(const vector<ScenarioOption>& options, const ScenarioAxes& axes, const ScenarioResult* result,
+                             const ScenarioSink* sink, bool greeks) const
+{
+    const size_t n = options.size(), nS = axes.S.size(), nSig = axes.sig.size(), nT = axes.T.size();
+    metrics::ScopedTimer timer(metrics::Engine::ScenarioGrid, metrics::Phase::Kernel);
+    metrics::count(metrics::Engine::ScenarioGrid, metrics::Counter::OptionsPriced, n * nS * nSig * nT);
+    for (double x : axes.S.values)
+        if (!(x > 0.0))
+            throw invalid_argument("ScenarioGridEngine: spot axis values must be positive");
+    for (const ScenarioOption& option : options)
+        for (size_t v = 0; v < nSig; v++)
+            if (!(AxisValue(axes.sig, v, option.p.sig) > 0.0))
+                throw invalid_argument("ScenarioGridEngine: a volatility on the grid is not positive");
+
+    // per spot node
+    vector<double> x(nS, 1.0), logx(nS, 0.0);
+    for (size_t s = 0; s < axes.S.values.size(); s++) {
+        x[s] = axes.S.values[s];
+        logx[s] = log(x[s]);
+    }
+
+    // per option, and per option and time node
+    bool relativeSpot = axes.S.values.empty() || axes.S.kind == AxisKind::Shift;
+    vector<OptionNode> nodes(n);
+    vector<TimeNode> times(n * nT);
+    for (size_t o = 0; o < n; o++) {
+        const OptionParameters& p = options[o].p;
+        double base = relativeSpot ? p.S : 1.0;
+        nodes[o] = OptionNode{base, log(base), log(p.K)};
+        if (options[o].model != PricingModel::European)
+            continue;
+        for (size_t t = 0; t < nT; t++) {
+            double T = AxisValue(axes.T, t, p.T);
+            if (!(T >= 0.0))
+                throw invalid_argument("ScenarioGridEngine: a time to expiry on the grid is negative");
+            times[o * nT + t] = TimeNode{T, sqrt(T), exp((p.b - p.r) * T), p.K * exp(-p.r * T)};
+        }
+    }
+
+    auto lineParams = [&](size_t o, size_t t, size_t v) {
+        const OptionParameters& p = options[o].p;
+        const OptionNode& node = nodes[o];
+        double sig = AxisValue(axes.sig, v, p.sig);
+        LineParams L{};
+        L.model = options[o].model;
+        L.w = p.type;
+        L.base = node.base;
+        if (L.model == PricingModel::European) {
+            const TimeNode& tn = times[o * nT + t];
+            L.expired = tn.T == 0.0;
+            L.vol = sig * tn.sqrtT;
+            L.invVol = 1.0 / L.vol;
+            L.shift = node.logBase - node.logK + (p.b + (sig * sig) * 0.5) * tn.T;
+            L.carry = tn.carry;
+            L.disc = tn.disc;
+        } else { // same expressions as PerpetualAmericanPrice<>
+            double sig2 = sig * sig;
+            double fac = p.b / sig2 - 0.5; fac *= fac;
+            L.y = 0.5 - p.b / sig2 + L.w * sqrt(fac + 2.0 * p.r / sig2);
+            L.degenerate = PerpetualDegenerate(p.type, L.y, p.r, p.b);
+            L.scale = p.K / (L.w * (L.y - 1.0));
+            L.shift = log((L.y - 1.0) / (L.y * p.K) * node.base);
+        }
+        return L;
+    };
+
+    const size_t lines = n * nT * nSig;
+    auto body = [&](size_t begin, size_t end) {
+        vector<double> buffer(sink ? 3 * nS : 0); // one line, reused
+        for (size_t line = begin; line < end; line++) {
+            size_t o = line / (nT * nSig), t = line / nSig % nT, v = line % nSig;
+            LineParams L = lineParams(o, t, v);
+            if (sink) {
+                double* price = buffer.data();
+                double* delta = greeks ? price + nS : nullptr;
+                double* gamma = greeks ? price + 2 * nS : nullptr;
+                ComputeLine(level, L, x.data(), logx.data(), nS, price, delta, gamma);
+                span<const double> all(buffer);
+                (*sink)(ScenarioLine{o, t, v, all.subspan(0, nS), greeks ? all.subspan(nS, nS) : span<const double>(),
+                                     greeks ? all.subspan(2 * nS, nS) : span<const double>()});
+            } else {
+                size_t offset = line * nS;
+                ComputeLine(level, L, x.data(), logx.data(), nS,
+                            result->price.empty() ? nullptr : result->price.data() + offset,
+                            result->delta.empty() ? nullptr : result->delta.data() + offset,
+                            result->gamma.empty() ? nullptr : result->gamma.data() + offset);
+            }
+        }
+    };
+
+    size_t chunk = max<size_t>(1, ChunkPoints / nS);
+    if (pool == nullptr || lines <= chunk)
+        body(0, lines);
+    else
+        pool->ParallelFor(lines, chunk, body);
+}
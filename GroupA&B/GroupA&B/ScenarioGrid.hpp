@@ -0,0 +1,102 @@
+//
+//  ScenarioGrid.hpp
+//  GroupA&B
+//  Spot x vol x time ladders of many options on one Cartesian grid
+//  Created by Kevin on 10/18/26.
+//
+//  A grid is the product of three axes, each either absolute levels or shifts
+//  of the option's own value (spot is multiplied, vol and time are added), an
+//  empty axis keeps the option's value. The work is split into lines of fixed
+//  (option, time, vol) running along the spot axis, and everything that does
+//  not vary along a line is computed once:
+//      per spot node:          log of the level or shift
+//      per option:             log K and the log of the base spot
+//      per option and time:    sqrt(T), e^{(b-r)T}, K e^{-rT}
+//      per line:               sig sqrt(T) and the d1 drift
+//  so a European point costs an add, a multiply and two normal cdfs, and a
+//  perpetual American point (the time axis is ignored) one exp. Lines are
+//  independent, so the results do not depend on the thread count.
+//
+//  Every volatility on the grid must be positive and every time to expiry
+//  non-negative, Compute() throws invalid_argument otherwise. A European
+//  option at T = 0 is priced at its payoff.
+//
+
+#ifndef ScenarioGrid_hpp
+#define ScenarioGrid_hpp
+
+#include <functional>
+#include <span>
+#include <vector>
+#include "Option.hpp"
+#include "SimdMath.hpp"
+#include "ThreadPool.hpp"
+
+using namespace std;
+
+enum class AxisKind { Absolute, Shift };
+
+struct ScenarioAxis {
+    vector<double> values; // e.g. from meshArray() or Range<double>::mesh()
+    AxisKind kind = AxisKind::Absolute;
+
+    size_t size() const { return values.empty() ? 1 : values.size(); }
+};
+
+struct ScenarioAxes {
+    ScenarioAxis S;   // spot levels, or factors on the option's spot
+    ScenarioAxis sig; // volatilities, or additive vol shifts
+    ScenarioAxis T;   // times to expiry, or additive time shifts
+
+    size_t Points() const { return S.size() * sig.size() * T.size(); }
+};
+
+struct ScenarioOption {
+    OptionParameters p;
+    PricingModel model = PricingModel::European;
+};
+
+// Caller-owned outputs of options.size() * axes.Points() points, spot fastest:
+//   index = ((option * nT + t) * nSig + v) * nS + s
+// An empty span means "do not compute".
+struct ScenarioResult {
+    span<double> price;
+    span<double> delta;
+    span<double> gamma;
+};
+
+// One line of the grid handed to a ScenarioSink, spans of nS points
+struct ScenarioLine {
+    size_t option, t, v;
+    span<const double> price;
+    span<const double> delta; // empty unless greeks were requested
+    span<const double> gamma;
+};
+typedef function<void(const ScenarioLine&)> ScenarioSink; // called from the pool threads
+
+// Dispatch as in EuropeanBatchPricer: the widest SIMD kernel along each line,
+// lines in chunks of about ChunkPoints points over the thread pool.
+class ScenarioGridEngine {
+private:
+    simd::SimdLevel level;
+    ThreadPool* pool; // nullptr keeps everything on the calling thread
+
+    void Run(const vector<ScenarioOption>& options, const ScenarioAxes& axes, const ScenarioResult* result,
+             const ScenarioSink* sink, bool greeks) const;
+
+public:
+    static const size_t ChunkPoints = 16384;
+
+    ScenarioGridEngine(); // widest kernel the cpu supports, shared thread pool
+    ScenarioGridEngine(simd::SimdLevel level, ThreadPool* pool = &ThreadPool::Shared());
+
+    simd::SimdLevel Level() const { return level; }
+
+    // Every point of the grid into the result columns
+    void Compute(const vector<ScenarioOption>& options, const ScenarioAxes& axes, const ScenarioResult& result) const;
+    // Line by line into sink, for grids too large to hold: only one line per thread is kept
+    void Compute(const vector<ScenarioOption>& options, const ScenarioAxes& axes, const ScenarioSink& sink,
+                 bool greeks = false) const;
+};
+
+#endif /* ScenarioGrid_hpp */
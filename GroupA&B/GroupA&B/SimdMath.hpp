@@ -0,0 +1,213 @@
+//
+//  SimdMath.hpp
+//  GroupA&B
+//  Vectorised exp, log, normal cdf and quantile on compiler vector types
+//  Created by Kevin on 10/18/26.
+//
+//  The math is written once on GCC/Clang vector extensions and force-inlined
+//  into per-ISA loops that carry a target attribute, so the same code is
+//  emitted as SSE2/NEON, AVX2 or AVX-512 and picked at run time.
+//  Domain: Log expects positive finite arguments, Exp flushes below e^-708 to 0.
+//
+
+#ifndef SimdMath_hpp
+#define SimdMath_hpp
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace simd {
+
+typedef double vd2 __attribute__((vector_size(16)));
+typedef double vd4 __attribute__((vector_size(32)));
+typedef double vd8 __attribute__((vector_size(64)));
+
+#define SIMD_INLINE inline __attribute__((always_inline))
+
+// Instruction set levels, ordered by vector width
+enum class SimdLevel { Scalar = 0, Simd128 = 1, Simd256 = 2, Simd512 = 3 }; // scalar, SSE2/NEON, AVX2+FMA, AVX-512F
+
+inline SimdLevel DetectSimdLevel()
+{ // widest level supported by the running cpu
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("avx512f"))
+        return SimdLevel::Simd512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return SimdLevel::Simd256;
+    if (__builtin_cpu_supports("sse2"))
+        return SimdLevel::Simd128;
+    return SimdLevel::Scalar;
+#else
+    return SimdLevel::Simd128;
+#endif
+}
+
+template <class V> constexpr int Lanes() { return sizeof(V) / sizeof(double); }
+template <class V> using Mask = decltype(V{} < V{}); // lane mask, all bits set when true
+
+template <class V> SIMD_INLINE V Broadcast(double x) { return V{} + x; }
+template <class V> SIMD_INLINE V Load(const double* p) { V v; memcpy(&v, p, sizeof(V)); return v; }
+template <class V> SIMD_INLINE void Store(double* p, V v) { memcpy(p, &v, sizeof(V)); }
+
+template <class V> SIMD_INLINE V Select(Mask<V> m, V a, V b)
+{ // a where m is set, b elsewhere
+    typedef Mask<V> I;
+    return (V)(((I)a & m) | ((I)b & ~m));
+}
+
+template <class V> SIMD_INLINE V Abs(V x)
+{
+    typedef Mask<V> I;
+    return (V)((I)x & 0x7fffffffffffffffLL);
+}
+
+template <class V> SIMD_INLINE V Exp(V x)
+{ // fdlibm reduction x = n*ln2 + r, |r| <= ln2/2, rational approximation of e^r
+    typedef Mask<V> I;
+    const double magic = 6755399441055744.0; // 1.5 * 2^52, rounds to nearest integer
+    V xc = Select<V>(x > 709.0, Broadcast<V>(709.0), x);
+    xc = Select<V>(xc < -708.0, Broadcast<V>(-708.0), xc);
+
+    V t = xc * 1.44269504088896338700 + magic;
+    V n = t - magic;
+    I ni = (I)t - (I)Broadcast<V>(magic);
+
+    V rr = (xc - n * 6.93147180369123816490e-01) - n * 1.90821492927058770002e-10;
+    V z = rr * rr;
+    V c = rr - z * (1.66666666666666019037e-01 + z * (-2.77777777770155933842e-03 + z * (6.61375632143793436117e-05
+                + z * (-1.65339022054652515390e-06 + z * 4.13813679705723846039e-08))));
+    V y = 1.0 - ((rr * c) / (c - 2.0) - rr);
+    y = y * (V)((ni + 1023) << 52);
+
+    y = Select<V>(x > 709.0, Broadcast<V>(HUGE_VAL), y);
+    return Select<V>(x < -708.0, V{}, y);
+}
+
+template <class V> SIMD_INLINE V Log(V x)
+{ // fdlibm: x = 2^k * (1+f), sqrt(2)/2 <= 1+f < sqrt(2), log(1+f) via s = f/(2+f)
+    typedef Mask<V> I;
+    const double magic = 6755399441055744.0;
+    I ix = (I)x + ((0x3ff00000LL - 0x3fe6a09eLL) << 32);
+    I k = (ix >> 52) - 0x3ff;
+    V m = (V)((ix & 0x000fffffffffffffLL) + (0x3fe6a09eLL << 32));
+    V dk = (V)(k + (I)Broadcast<V>(magic)) - magic;
+
+    V f = m - 1.0;
+    V hfsq = 0.5 * f * f;
+    V s = f / (2.0 + f);
+    V z = s * s;
+    V w = z * z;
+    V t1 = w * (3.999999999940941908e-01 + w * (2.222219843214978396e-01 + w * 1.531383769920937332e-01));
+    V t2 = z * (6.666666666666735130e-01 + w * (2.857142874366239149e-01 + w * (1.818357216161805012e-01
+                + w * 1.479819860511658591e-01)));
+    V R = t2 + t1;
+    return s * (hfsq + R) + dk * 1.90821492927058770002e-10 - hfsq + f + dk * 6.93147180369123816490e-01;
+}
+
+template <class V> SIMD_INLINE V NormalCdf(V x, V& pdf)
+{ // Hart (1968) double precision algorithm, erfc(|x|/sqrt(2))/2 as a rational function times exp(-x^2/2)
+    V ax = Abs(x);
+    V e = Exp(-0.5 * ax * ax);
+    pdf = e * 0.398942280401432677940;
+
+    V num = 3.52624965998911e-02 * ax + 0.700383064443688;
+    num = num * ax + 6.37396220353165;
+    num = num * ax + 33.912866078383;
+    num = num * ax + 112.079291497871;
+    num = num * ax + 221.213596169931;
+    num = num * ax + 220.206867912376;
+    V den = 8.83883476483184e-02 * ax + 1.75566716318264;
+    den = den * ax + 16.064177579207;
+    den = den * ax + 86.7807322029461;
+    den = den * ax + 296.564248779674;
+    den = den * ax + 637.333633378831;
+    den = den * ax + 793.826512519948;
+    den = den * ax + 440.413735824752;
+    V inner = e * num / den;
+
+    V cf = ax + 0.65; // continued fraction for the far tail
+    cf = ax + 4.0 / cf;
+    cf = ax + 3.0 / cf;
+    cf = ax + 2.0 / cf;
+    cf = ax + 1.0 / cf;
+    V outer = e / cf / 2.506628274631;
+
+    V tail = Select<V>(ax < 7.07106781186547, inner, outer);
+    return Select<V>(x > 0.0, 1.0 - tail, tail);
+}
+
+template <class V> SIMD_INLINE V NormalCdf(V x)
+{
+    V pdf;
+    return NormalCdf(x, pdf);
+}
+
+template <class V> SIMD_INLINE V Min(V a, V b) { return Select<V>(a < b, a, b); }
+template <class V> SIMD_INLINE V Max(V a, V b) { return Select<V>(a > b, a, b); }
+
+template <class V, class Ops> SIMD_INLINE V NormalInv(V p)
+{ // Acklam's rational approximation of the normal quantile, relative error below 1.2e-9, p in (0, 1)
+    V q = p - 0.5;
+    V rr = q * q;
+    V num = -3.969683028665376e+01 * rr + 2.209460984245205e+02;
+    num = num * rr - 2.759285104469687e+02;
+    num = num * rr + 1.383577518672690e+02;
+    num = num * rr - 3.066479806614716e+01;
+    num = num * rr + 2.506628277459239e+00;
+    V den = -5.447609879822406e+01 * rr + 1.615858368580409e+02;
+    den = den * rr - 1.556989798598866e+02;
+    den = den * rr + 6.680131188771972e+01;
+    den = den * rr - 1.328068155288572e+01;
+    den = den * rr + 1.0;
+    V central = num * q / den;
+
+    V pt = Max(Min(p, 1.0 - p), Broadcast<V>(1e-300)); // tails through the smaller probability
+    V t = Ops::Sqrt(-2.0 * Log(pt));
+    V tnum = -7.784894002430293e-03 * t - 3.223964580411365e-01;
+    tnum = tnum * t - 2.400758277161838e+00;
+    tnum = tnum * t - 2.549732539343734e+00;
+    tnum = tnum * t + 4.374664141464968e+00;
+    tnum = tnum * t + 2.938163982698783e+00;
+    V tden = 7.784695709041462e-03 * t + 3.224671290700398e-01;
+    tden = tden * t + 2.445134137142996e+00;
+    tden = tden * t + 3.754408661907416e+00;
+    tden = tden * t + 1.0;
+    V tail = tnum / tden;
+    tail = Select<V>(p > 0.5, -tail, tail);
+
+    return Select<V>(Abs(q) <= 0.47575, central, tail);
+}
+
+// Per-ISA square roots. They are not force-inlined (a generic caller could not
+// inline a target function), the optimiser inlines them once the generic body
+// has landed in the matching target loop.
+struct GenericOps {
+    template <class V> static V Sqrt(V x)
+    {
+        for (int i = 0; i < Lanes<V>(); i++)
+            x[i] = std::sqrt(x[i]);
+        return x;
+    }
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+struct Sse2Ops {
+    __attribute__((target("sse2"))) static inline vd2 Sqrt(vd2 x) { return (vd2)_mm_sqrt_pd((__m128d)x); }
+};
+
+struct Avx2Ops {
+    __attribute__((target("avx2,fma"))) static inline vd4 Sqrt(vd4 x) { return (vd4)_mm256_sqrt_pd((__m256d)x); }
+};
+
+struct Avx512Ops {
+    __attribute__((target("avx512f"))) static inline vd8 Sqrt(vd8 x) { return (vd8)_mm512_mask_sqrt_pd((__m512d)x, 0xff, (__m512d)x); }
+};
+#endif
+
+} // namespace simd
+
+#endif /* SimdMath_hpp */
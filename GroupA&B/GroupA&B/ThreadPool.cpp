@@ -0,0 +1,127 @@
+//
+//  ThreadPool.cpp
+//  GroupA&B
+//  Reusable thread pool implementation
+//  Created by Kevin on 10/18/26.
+//
+
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+static thread_local bool insidePool = false; // true on pool workers and inside a running body
+
+ThreadPool::ThreadPool(size_t nThreads)
+{
+    nThreads = max<size_t>(nThreads, 1);
+    for (size_t i = 0; i < nThreads; i++)
+        queues.push_back(make_unique<ChunkQueue>());
+    for (size_t i = 1; i < nThreads; i++)
+        workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> guard(stateLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (thread& t: workers)
+        t.join();
+}
+
+ThreadPool& ThreadPool::Shared()
+{
+    static ThreadPool pool(thread::hardware_concurrency());
+    return pool;
+}
+
+bool ThreadPool::RunOne(size_t id)
+{
+    pair<size_t, size_t> range;
+    bool found = false;
+    for (size_t k = 0; k < queues.size() && !found; k++) {
+        ChunkQueue& q = *queues[(id + k) % queues.size()];
+        lock_guard<mutex> guard(q.lock);
+        if (q.chunks.empty())
+            continue;
+        if (k == 0) { // own queue from the front, victims from the back
+            range = q.chunks.front();
+            q.chunks.pop_front();
+        } else {
+            range = q.chunks.back();
+            q.chunks.pop_back();
+        }
+        found = true;
+    }
+    if (!found)
+        return false;
+
+    try {
+        (*body)(range.first, range.second);
+    } catch (...) {
+        lock_guard<mutex> guard(stateLock);
+        if (!error)
+            error = current_exception();
+    }
+    if (remaining.fetch_sub(1) == 1) {
+        lock_guard<mutex> guard(stateLock);
+        done.notify_all();
+    }
+    return true;
+}
+
+void ThreadPool::WorkerLoop(size_t id)
+{
+    insidePool = true;
+    size_t seen = 0;
+    for (;;) {
+        {
+            unique_lock<mutex> guard(stateLock);
+            wake.wait(guard, [&] { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+        }
+        while (RunOne(id)) {}
+    }
+}
+
+void ThreadPool::ParallelFor(size_t n, size_t chunk, const function<void(size_t, size_t)>& f)
+{
+    if (n == 0)
+        return;
+    chunk = max<size_t>(chunk, 1);
+    if (insidePool || queues.size() == 1 || n <= chunk) {
+        for (size_t begin = 0; begin < n; begin += chunk)
+            f(begin, min(n, begin + chunk));
+        return;
+    }
+
+    lock_guard<mutex> run(runLock);
+    size_t nChunks = (n + chunk - 1) / chunk;
+    size_t perQueue = (nChunks + queues.size() - 1) / queues.size();
+    body = &f;
+    error = nullptr;
+    remaining = nChunks;
+    for (size_t c = 0; c < nChunks; c++) { // contiguous runs of chunks per participant
+        ChunkQueue& q = *queues[c / perQueue];
+        lock_guard<mutex> guard(q.lock);
+        q.chunks.emplace_back(c * chunk, min(n, (c + 1) * chunk));
+    }
+    {
+        lock_guard<mutex> guard(stateLock);
+        generation++;
+    }
+    wake.notify_all();
+
+    insidePool = true;
+    while (RunOne(0)) {}
+    insidePool = false;
+
+    unique_lock<mutex> guard(stateLock);
+    done.wait(guard, [&] { return remaining.load() == 0; });
+    body = nullptr;
+    if (error)
+        rethrow_exception(error);
+}
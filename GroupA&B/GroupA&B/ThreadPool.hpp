@@ -0,0 +1,60 @@
+//
+//  ThreadPool.hpp
+//  GroupA&B
+//  Reusable thread pool with work stealing over chunked row ranges
+//  Created by Kevin on 10/18/26.
+//
+
+#ifndef ThreadPool_hpp
+#define ThreadPool_hpp
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+class ThreadPool {
+private:
+    struct ChunkQueue { // row ranges owned by one participant, stolen from the back
+        mutex lock;
+        deque<pair<size_t, size_t>> chunks;
+    };
+
+    vector<thread> workers;
+    vector<unique_ptr<ChunkQueue>> queues; // queues[0] belongs to the calling thread
+    mutex runLock;                         // one ParallelFor at a time
+    mutex stateLock;
+    condition_variable wake;
+    condition_variable done;
+    const function<void(size_t, size_t)>* body = nullptr;
+    size_t generation = 0;
+    atomic<size_t> remaining{0}; // chunks not finished yet
+    exception_ptr error;
+    bool stopping = false;
+
+    void WorkerLoop(size_t id);
+    bool RunOne(size_t id); // pop or steal one chunk and run it, false when none left
+
+public:
+    explicit ThreadPool(size_t nThreads); // nThreads participants, the caller included
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator = (const ThreadPool&) = delete;
+    ~ThreadPool();
+
+    size_t Size() const { return queues.size(); }
+
+    // Run body(begin, end) over [0, n) in chunks of at most chunk rows and wait for all of them.
+    // Nested calls from inside a body run serially on the calling thread.
+    void ParallelFor(size_t n, size_t chunk, const function<void(size_t, size_t)>& body);
+
+    static ThreadPool& Shared(); // process-wide pool sized to the hardware
+};
+
+#endif /* ThreadPool_hpp */
@@ -8,13 +8,357 @@
 #include <iostream>
 #include "EuropeanOption.hpp"
 #include "PerpetualAmericanOptions.hpp"
+#include "BatchPricer.hpp"
+#include "ImpliedVolSolver.hpp"
+#include "ColumnFile.hpp"
+#include "PricingCache.hpp"
+#include "ScenarioGrid.hpp"
+#include "Portfolio.hpp"
+#include "PerpetualBatchPricer.hpp"
+#include "FiniteDifferenceGreeks.hpp"
+#include "Metrics.hpp"
 #include <vector>
 #include <iomanip>
 #include <random>
+#include <cmath>
+#include <filesystem>
+#include <cstring>
+#include <atomic>
 using namespace std;
 
+// Price() from the cached invariants against the closed form of the fields,
+// after every constructor and after every setter. Returns the failures.
+static int CheckInvariants()
+{
+    int failures = 0;
+    auto check = [&](const string& what, double cached, double direct) {
+        if (!(fabs(cached - direct) <= 1e-12 * max(1.0, fabs(direct)))) {
+            cout << "Invariant check failed: " << what << " " << cached << " vs " << direct << endl;
+            failures++;
+        }
+    };
+    auto checkPerpetual = [&](const string& what, const PerpetualAmericanOption& o) {
+        check("perpetual " + what, o.Price(), o.type() == Call ? o.Price<Call>() : o.Price<Put>());
+    };
+    auto checkEuropean = [&](const string& what, const EuropeanOption& o) {
+        OptionParameters p = o.Parameters();
+        check("european price " + what, o.Price(), EuropeanOption::PriceOf(p));
+        check("european delta " + what, o.Delta(), o.type() == Call ? BlackScholesDelta<Call>(p.T, p.K, p.sig, p.r, p.b, p.S)
+                                                                  : BlackScholesDelta<Put>(p.T, p.K, p.sig, p.r, p.b, p.S));
+        check("european gamma " + what, o.Gamma(), BlackScholesGamma(p.T, p.K, p.sig, p.r, p.b, p.S));
+    };
+
+    for (OptionType type : {Call, Put}) {
+        string name = ToString(type);
+        vector<pair<string, PerpetualAmericanOption>> perpetual = {
+            {"default", PerpetualAmericanOption()}, {"type " + name, PerpetualAmericanOption(name)},
+            {"fields " + name, PerpetualAmericanOption(100, 0.1, 0.1, 0.02, 110, type)},
+            {"matrix " + name, PerpetualAmericanOption(vector<vector<double>>(), name)}};
+        perpetual.push_back({"copy " + name, PerpetualAmericanOption(perpetual[1].second)});
+        for (auto& [what, o] : perpetual) {
+            o.setS(110); checkPerpetual(what, o);
+            o.setSig(0.2); checkPerpetual(what + " setSig", o);
+            o.setB(0.03); checkPerpetual(what + " setB", o); // b < r keeps the call exponent above one
+            o.setR(0.08); checkPerpetual(what + " setR", o);
+            o.setK(95); checkPerpetual(what + " setK", o);
+            o.setS(100); checkPerpetual(what + " setS", o);
+            o.toggle(); checkPerpetual(what + " toggle", o);
+        }
+
+        vector<pair<string, EuropeanOption>> european = {
+            {"default", EuropeanOption()}, {"type " + name, EuropeanOption(name)},
+            {"fields " + name, EuropeanOption(0.25, 65, 0.30, 0.08, 0.08, 60, type)},
+            {"matrix " + name, EuropeanOption(vector<vector<double>>(), name)}};
+        european.push_back({"copy " + name, EuropeanOption(european[2].second)});
+        for (auto& [what, o] : european) {
+            o.setS(100); checkEuropean(what, o);
+            o.setT(0.75); checkEuropean(what + " setT", o);
+            o.setSig(0.25); checkEuropean(what + " setSig", o);
+            o.setR(0.04); checkEuropean(what + " setR", o);
+            o.setB(0.02); checkEuropean(what + " setB", o);
+            o.setK(105); checkEuropean(what + " setK", o);
+            o.setS(95); checkEuropean(what + " setS", o);
+            o.toggle(); checkEuropean(what + " toggle", o);
+        }
+    }
+    return failures;
+}
+
+// Bump-and-revalue greeks of every row and both types against Evaluate() and the
+// closed-form vanna, one object and the batch engine per scheme. Central
+// differences must agree to CentralTol, forward ones to ForwardTol, relative to
+// max(1, |closed form|). Returns the failures.
+static int CheckFiniteDifferenceGreeks(const vector<vector<double>>& parameter_matrix)
+{
+    const double CentralTol = 1e-5, ForwardTol = 1e-2;
+    int failures = 0;
+    for (DifferenceScheme scheme : {DifferenceScheme::Central, DifferenceScheme::Forward}){
+        bool central = scheme == DifferenceScheme::Central;
+        FiniteDifferenceGreeks<EuropeanPricer> bumped(EuropeanPricer(), BumpSizes(), scheme);
+        double max_err = 0.0;
+        auto compare = [&](double value, double exact) {
+            max_err = max(max_err, fabs(value - exact) / max(1.0, fabs(exact)));
+        };
+        for (OptionType type : {Call, Put}){
+            for (const vector<double>& row : parameter_matrix){
+                OptionParameters p{row[0], row[1], row[2], row[3], row[4], row[5], type};
+                OptionValues v = EuropeanOption(p.T, p.K, p.sig, p.r, p.b, p.S, type).Evaluate();
+                double sqrtT = sqrt(p.T), d1 = (log(p.S / p.K) + (p.b + 0.5 * p.sig * p.sig) * p.T) / (p.sig * sqrtT);
+                double vanna = -exp((p.b - p.r) * p.T) * exp(-0.5 * d1 * d1) / sqrt(2.0 * M_PI) * (d1 - p.sig * sqrtT) / p.sig;
+                FiniteDifferenceResult g = bumped.Compute(p);
+                compare(g.price, type == Call ? v.callPrice : v.putPrice);
+                compare(g.delta, type == Call ? v.callDelta : v.putDelta);
+                compare(g.gamma, v.gamma);
+                compare(g.vega, v.vega);
+                compare(g.theta, type == Call ? v.callTheta : v.putTheta);
+                compare(g.rho, type == Call ? v.callRho : v.putRho);
+                compare(g.vanna, vanna);
+                compare(bumped.Delta(p), type == Call ? v.callDelta : v.putDelta);
+                compare(bumped.Gamma(p), v.gamma);
+            }
+        }
+        bool ok = max_err <= (central ? CentralTol : ForwardTol); // also false for a NaN
+        failures += ok ? 0 : 1;
+        cout << (central ? "Central" : "Forward") << " difference greeks, max relative |bumped - closed form| = " << max_err
+             << (ok ? "" : "  FAILED") << endl;
+    }
+
+    //the batch engine, central differences over the SIMD pricer
+    BatchFiniteDifferenceGreeks<EuropeanBatchPriceFunction> batch_greeks;
+    size_t n = parameter_matrix.size();
+    vector<double> price(n), delta(n), gamma(n), vega(n), theta(n), rho(n);
+    double max_err = 0.0;
+    for (OptionType type : {Call, Put}){
+        EuropeanColumns columns(parameter_matrix, type);
+        batch_greeks.Compute(columns.Batch(), BumpedBatchResult{price, delta, gamma, vega, theta, rho});
+        for (size_t i = 0; i < n; i++){
+            const vector<double>& row = parameter_matrix[i];
+            OptionValues v = EuropeanOption(row[0], row[1], row[2], row[3], row[4], row[5], type).Evaluate();
+            bool call = type == Call;
+            for (auto [value, exact] : {pair{price[i], call ? v.callPrice : v.putPrice}, pair{delta[i], call ? v.callDelta : v.putDelta},
+                                        pair{gamma[i], v.gamma}, pair{vega[i], v.vega}, pair{theta[i], call ? v.callTheta : v.putTheta},
+                                        pair{rho[i], call ? v.callRho : v.putRho}})
+                max_err = max(max_err, fabs(value - exact) / max(1.0, fabs(exact)));
+        }
+    }
+    bool ok = max_err <= CentralTol; // also false for a NaN
+    failures += ok ? 0 : 1;
+    cout << "Batch central difference greeks, max relative |bumped - closed form| = " << max_err << (ok ? "" : "  FAILED") << endl;
+    return failures;
+}
+
+// Price, delta, gamma and exercise boundary of the perpetual batch pricer, a
+// mixed-type batch at every level and spot ladders, against the scalar class.
+// The rows with b == r sit at the call pole, where y1 rounds to 1 or just below.
+// Returns the failures.
+static int CheckPerpetualBatch(const vector<vector<double>>& parameter_matrix2, const vector<double>& S_values)
+{
+    vector<vector<double>> rows = parameter_matrix2; // {K, sig, r, b, S}
+    for (double sig : {0.1, 0.15, 0.3})
+        for (double r : {0.02, 0.08, 0.1})
+            rows.push_back({100.0, sig, r, r, 110.0});
+    vector<double> K, sig, r, b, S;
+    vector<OptionType> type;
+    for (OptionType t : {Call, Put})
+        for (const vector<double>& row : rows){
+            K.push_back(row[0]); sig.push_back(row[1]); r.push_back(row[2]); b.push_back(row[3]); S.push_back(row[4]);
+            type.push_back(t);
+        }
+
+    double max_err = 0.0;
+    auto compare = [&](const OptionParameters& p, double price, double delta, double gamma, double boundary) {
+        PerpetualAmericanOption option(p.K, p.sig, p.r, p.b, p.S, p.type);
+        const PerpetualInvariants& inv = option.Invariants();
+        double exact_price = option.Price();
+        double exact_delta = inv.degenerate ? 1.0 : inv.y * exact_price / p.S;
+        double exact_gamma = inv.degenerate ? 0.0 : (inv.y - 1.0) * exact_delta / p.S;
+        double exact_boundary = inv.degenerate ? (p.type == Call ? INFINITY : 0.0) : 1.0 / inv.ratio;
+        for (auto [value, exact] : {pair{price, exact_price}, pair{delta, exact_delta}, pair{gamma, exact_gamma}})
+            max_err = max(max_err, fabs(value - exact) / max(1.0, fabs(exact)));
+        if (isinf(exact_boundary))
+            max_err = max(max_err, boundary == exact_boundary ? 0.0 : INFINITY);
+        else
+            max_err = max(max_err, fabs(boundary - exact_boundary) / max(1.0, fabs(exact_boundary)));
+    };
+
+    size_t n = S.size();
+    vector<double> price(n), delta(n), gamma(n), boundary(n);
+    for (int level = 0; level <= (int)simd::DetectSimdLevel(); level++){
+        PerpetualAmericanBatchPricer pricer((simd::SimdLevel)level);
+        pricer.Compute(PerpetualBatch{K, sig, r, b, S, type}, PerpetualBatchResult{price, delta, gamma, boundary});
+        for (size_t i = 0; i < n; i++)
+            compare(OptionParameters{0.0, K[i], sig[i], r[i], b[i], S[i], type[i]}, price[i], delta[i], gamma[i], boundary[i]);
+
+        //one ladder off the pole and one on it, both types
+        size_t m = S_values.size();
+        vector<double> ladder_price(m), ladder_delta(m), ladder_gamma(m), ladder_boundary(m);
+        for (size_t row : {size_t(0), rows.size() - 1})
+            for (OptionType t : {Call, Put}){
+                OptionParameters p{0.0, rows[row][0], rows[row][1], rows[row][2], rows[row][3], 0.0, t};
+                pricer.SpotLadder(p, S_values, PerpetualBatchResult{ladder_price, ladder_delta, ladder_gamma, ladder_boundary});
+                for (size_t i = 0; i < m; i++){
+                    p.S = S_values[i];
+                    compare(p, ladder_price[i], ladder_delta[i], ladder_gamma[i], ladder_boundary[i]);
+                }
+            }
+    }
+    bool ok = max_err <= 1e-12; // also false for a NaN
+    cout << "Perpetual batch and spot ladders, " << n << " rows, " << 2 * 9 << " of them with b == r, max relative |batch - scalar| of "
+         << "price, delta, gamma, boundary = " << max_err << (ok ? "" : "  FAILED") << endl;
+    return ok ? 0 : 1;
+}
+
+// The pricing cache behind the European closed form and its difference greeks:
+// hit and miss counts, a hot entry kept through CLOCK eviction in full shards,
+// values on a quantization grid, and concurrent lookups from the pool. Cached
+// values must equal the pricer on the quantized block bitwise. Returns the failures.
+static int CheckPricingCache(const vector<double>& S_values)
+{
+    int failures = 0;
+    auto report = [&](const string& what, bool ok, const PricingCacheStats& stats) {
+        failures += ok ? 0 : 1;
+        cout << what << ": hits " << stats.hits << " misses " << stats.misses << " evictions " << stats.evictions
+             << " size " << stats.size << (ok ? "" : "  FAILED") << endl;
+    };
+
+    //the European sweep twice, the second pass is all hits
+    PricingCache cache(1024);
+    EuropeanOption::SetPricingCache(&cache);
+    EuropeanOption option(0.5, 100, 0.36, 0.1, 0, 105, "C");
+    bool ok = true;
+    for (int pass = 0; pass < 2; pass++)
+        for (double S : S_values){
+            option.setS(S);
+            ok = ok && option.Price() == EuropeanOption::PriceOf(option.Parameters());
+        }
+    PricingCacheStats stats = cache.Stats();
+    report("Cached European sweep", ok && stats.hits == S_values.size() && stats.misses == S_values.size(), stats);
+
+    //Delta(h) misses both bumps, Gamma(h) then hits them and misses the centre, Delta(h) again hits both
+    cache.Clear();
+    option.setS(100);
+    double delta = option.Delta(0.01), gamma = option.Gamma(0.01), delta_again = option.Delta(0.01);
+    stats = cache.Stats();
+    EuropeanOption::SetPricingCache(nullptr);
+    ok = delta == option.Delta(0.01) && gamma == option.Gamma(0.01) && delta_again == delta;
+    report("Cached difference greeks", ok && stats.hits == 4 && stats.misses == 3, stats);
+
+    //4 slots per shard: a hot entry read after every insert keeps its CLOCK bit and is never evicted
+    PricingCache small(4 * PricingCache::Shards);
+    auto price = [](const OptionParameters& p) { return EuropeanOption::PriceOf(p); };
+    OptionParameters hot{0.5, 100.0, 0.2, 0.05, 0.02, 100.0, Call};
+    ok = small.GetOrCompute(PricingModel::European, hot, price) == price(hot);
+    const uint64_t Inserts = 1000;
+    for (uint64_t i = 0; i < Inserts; i++){
+        OptionParameters cold = hot;
+        cold.S = 200.0 + 0.1 * double(i); //never the hot spot
+        ok = ok && small.GetOrCompute(PricingModel::European, cold, price) == price(cold);
+        ok = ok && small.GetOrCompute(PricingModel::European, hot, price) == price(hot);
+    }
+    stats = small.Stats();
+    ok = ok && stats.hits == Inserts && stats.misses == Inserts + 1 && stats.size == stats.capacity
+        && stats.evictions == Inserts + 1 - stats.size;
+    report("Full cache of " + to_string(stats.capacity) + " slots, one hot entry", ok, stats);
+
+    //spot on a 0.5 grid and vol on a 0.01 grid: quotes in one cell share the price at the grid point
+    CacheQuantization grid;
+    grid.S = 0.5;
+    grid.sig = 0.01;
+    PricingCache snapped(1024, grid);
+    OptionParameters quote{1.0, 100.0, 0.2012, 0.05, 0.02, 100.2, Put}, neighbour = quote, point = quote;
+    neighbour.S = 99.9;
+    neighbour.sig = 0.1996;
+    point.S = 100.0;
+    point.sig = 0.2;
+    double first = snapped.GetOrCompute(PricingModel::European, quote, price);
+    double second = snapped.GetOrCompute(PricingModel::European, neighbour, price);
+    stats = snapped.Stats();
+    ok = first == price(point) && second == first && stats.hits == 1 && stats.misses == 1;
+    report("Quantized cache, two quotes in one cell", ok, stats);
+
+    //100 keys read 100 times each from the pool; racing misses may price a key twice
+    PricingCache shared(1024);
+    const size_t Keys = 100, Reads = 100 * Keys;
+    atomic<bool> values_ok{true};
+    ThreadPool::Shared().ParallelFor(Reads, 64, [&](size_t begin, size_t end){
+        for (size_t i = begin; i < end; i++){
+            OptionParameters p = hot;
+            p.K = 50.0 + double(i % Keys);
+            if (shared.GetOrCompute(PricingModel::European, p, price) != price(p))
+                values_ok = false;
+        }
+    });
+    stats = shared.Stats();
+    ok = values_ok && stats.hits + stats.misses == Reads && stats.misses >= Keys && stats.size == Keys && stats.evictions == 0;
+    failures += ok ? 0 : 1; //the split of hits and misses depends on the scheduling, so it is not printed
+    cout << "Concurrent cache reads from the pool: " << Reads << " reads of " << stats.size << " keys"
+         << (ok ? ", every value exact" : "  FAILED") << endl;
+    return failures;
+}
+
+// A book of several blocks taken through updates, ticks, quantity 0 and expiry
+// by Revalue() after each change, against the same positions in a new book.
+// Returns 1 unless every figure agrees bitwise, the expired position is worth
+// its payoff and a negative time to expiry is rejected.
+static int CheckIncrementalBook(ThreadPool* pool)
+{
+    const char* names[] = {"SPX", "NDX", "RUT"};
+    Portfolio book({0.25, 0.5, 1.0, 2.0, 5.0}, pool);
+    for (int i = 0; i < 1000; i++){
+        OptionParameters p{0.25 * (1 + i % 24), 80.0 + i % 41, 0.15 + 0.01 * (i % 20), 0.05, 0.02, 100.0, i % 3 ? Call : Put};
+        book.Add(Position{names[i * 3 / 1000], p, i % 7 ? PricingModel::European : PricingModel::PerpetualAmerican, 1.0 + i % 5});
+    }
+    book.Revalue();
+
+    Position moved = book[10];
+    moved.p.T = 7.0; //to the last expiry bucket
+    book.Update(10, moved);
+    book.Revalue();
+    Position closed = book[400];
+    closed.quantity = 0.0;
+    book.Update(400, closed);
+    Position switched = book[700];
+    switched.underlying = "NDX"; //out of the RUT block into another underlying
+    book.Update(700, switched);
+    Position expired = book[20];
+    expired.p.T = 0.0;
+    book.Update(20, expired);
+    book.SetSpot("SPX", 101.5);
+    book.Revalue();
+    book.SetSpot("RUT", 97.0);
+    book.Revalue();
+
+    Portfolio fresh({0.25, 0.5, 1.0, 2.0, 5.0}, pool);
+    for (size_t id = 0; id < book.Size(); id++)
+        fresh.Add(book[id]);
+    fresh.Revalue();
+
+    auto same = [](const RiskFigures& a, const RiskFigures& b) { return memcmp(&a, &b, sizeof(RiskFigures)) == 0; };
+    bool ok = same(book.Total(), fresh.Total());
+    for (size_t id = 0; id < book.Size(); id++)
+        ok = ok && same(book.Risk(id), fresh.Risk(id));
+    vector<BucketRisk> incremental = book.Buckets(), rebuilt = fresh.Buckets();
+    ok = ok && incremental.size() == rebuilt.size();
+    for (size_t i = 0; ok && i < incremental.size(); i++)
+        ok = incremental[i].underlying == rebuilt[i].underlying && incremental[i].expiry == rebuilt[i].expiry
+            && same(incremental[i].risk, rebuilt[i].risk);
+
+    const Position& at_expiry = book[20];
+    const double w = at_expiry.p.type;
+    double intrinsic = w * (at_expiry.p.S - at_expiry.p.K);
+    RiskFigures payoff{at_expiry.quantity * max(intrinsic, 0.0), intrinsic > 0.0 ? at_expiry.quantity * w : 0.0, 0.0, 0.0};
+    ok = ok && same(book.Risk(20), payoff);
+    Position negative = book[30];
+    negative.p.T = -0.25;
+    try {
+        book.Add(negative);
+        ok = false;
+    } catch (const invalid_argument&) {}
+    return ok ? 0 : 1;
+}
 
 int main(int argc, const char * argv[]) {
+    int failures = 0; // checks below that disagree with the reference, the exit status is 1 if any
     // A Exact Solution of One-factor Plain Options
     // a)
     // Initialize 4 call options
@@ -55,6 +399,16 @@ int main(int argc, const char * argv[]) {
         cout << "S=" << *it << "   Price=" << Cbatches[0].Price() <<endl;
         prices.push_back(Cbatches[0].Price());
     }
+
+    //the same sweep as a spot ladder on the scenario engine
+    ScenarioAxes ladder;
+    ladder.S.values = S_values;
+    vector<double> ladder_prices(S_values.size());
+    ScenarioGridEngine().Compute({ScenarioOption{Cbatches[0].Parameters()}}, ladder, ScenarioResult{ladder_prices, {}, {}});
+    double ladder_err = 0.0;
+    for (size_t i = 0; i < S_values.size(); i++)
+        ladder_err = max(ladder_err, fabs(ladder_prices[i] - prices[i]));
+    cout << "Scenario ladder max |grid - Price()| = " << ladder_err << endl;
     
     //d) test with matrix of different parameters
     vector<double> r_values = meshArray(0.00, 0.08, 0.02);
@@ -85,13 +439,127 @@ int main(int argc, const char * argv[]) {
     option_matrix.toggle();
     option_matrix.optionMatrix("price");
     option_matrix.PrintOptionResult("price");
-    
+
+    //e) check the SIMD batch kernels against the boost-based closed form,
+    //price, delta and gamma of both types at every level the cpu supports
+    const double simd_tol = 1e-12; // relative to max(1, |boost value|)
+    EuropeanColumns columns(parameter_matrix, Call);
+    vector<double> simd_prices(parameter_matrix.size()); // call prices, quoted in f)
+    for (OptionType type : {Call, Put}){
+        EuropeanColumns type_columns(parameter_matrix, type);
+        vector<double> price(parameter_matrix.size()), delta(parameter_matrix.size()), gamma(parameter_matrix.size());
+        for (int level = 0; level <= (int)simd::DetectSimdLevel(); level++){
+            EuropeanBatchPricer((simd::SimdLevel)level).Compute(type_columns.Batch(), BatchResult{price, delta, gamma});
+            double max_err = 0.0;
+            for (size_t i = 0; i < parameter_matrix.size(); i++){
+                vector<double>& row = parameter_matrix[i];
+                EuropeanOption option(row[0], row[1], row[2], row[3], row[4], row[5], ToString(type));
+                max_err = max(max_err, fabs(option.Price() - price[i]) / max(1.0, fabs(option.Price())));
+                max_err = max(max_err, fabs(option.Delta() - delta[i]) / max(1.0, fabs(option.Delta())));
+                max_err = max(max_err, fabs(option.Gamma() - gamma[i]) / max(1.0, fabs(option.Gamma())));
+            }
+            bool ok = max_err <= simd_tol; // also false for a NaN
+            failures += ok ? 0 : 1;
+            cout << "SIMD level " << level << " " << ToString(type) << " max relative |batch - boost| of price, delta, gamma = "
+                 << max_err << (ok ? "" : "  FAILED") << endl;
+        }
+        if (type == Call)
+            simd_prices = price;
+    }
+
+    //f) back out the volatilities from the prices
+    EuropeanBatch batch = columns.Batch();
+    ImpliedVolBatch quotes{batch.T, batch.K, batch.r, batch.b, batch.S, simd_prices, {}};
+    vector<double> implied(parameter_matrix.size());
+    for (int level = 0; level <= (int)simd::DetectSimdLevel(); level++){
+        ImpliedVolResult out;
+        out.sig = implied;
+        ImpliedVolSolver((simd::SimdLevel)level).Compute(quotes, out);
+        double max_err = 0.0;
+        for (size_t i = 0; i < parameter_matrix.size(); i++)
+            max_err = max(max_err, fabs(implied[i] - parameter_matrix[i][2]));
+        cout << "SIMD level " << level << " max |implied vol - sig| = " << max_err << endl;
+    }
+
+    //calls and puts from deep out of to deep in the money, low and high vol, so both initial
+    //guesses are taken, and quotes outside the no-arbitrage bounds, which must come back NaN.
+    //A quote that rounds to zero, or an in-the-money one whose time value is lost in the
+    //rounding of its price, is left out: the double price does not define its vol
+    const double NaN = numeric_limits<double>::quiet_NaN();
+    vector<double> iv_T, iv_K, iv_r, iv_b, iv_S, iv_price, iv_sig;
+    vector<OptionType> iv_type;
+    vector<IVStatus> iv_expected;
+    auto quote = [&](double T, double K, double sig, OptionType type, double price, IVStatus expected){
+        iv_T.push_back(T); iv_K.push_back(K); iv_r.push_back(0.05); iv_b.push_back(0.02); iv_S.push_back(100.0);
+        iv_sig.push_back(sig); iv_type.push_back(type); iv_price.push_back(price); iv_expected.push_back(expected);
+    };
+    for (OptionType type : {Call, Put}){
+        for (double K : {60.0, 90.0, 100.0, 110.0, 150.0})
+            for (double sig : {0.1, 0.3, 0.8})
+                for (double T : {0.25, 2.0}){
+                    OptionValues v = EuropeanOption(T, K, sig, 0.05, 0.02, 100.0, type).Evaluate();
+                    double price = type == Call ? v.callPrice : v.putPrice;
+                    if (price > 0.0 && min(v.callPrice, v.putPrice) >= 1e-6 * price)
+                        quote(T, K, sig, type, price, IVStatus::Converged);
+                }
+        double T = 1.0, forward = 100.0 * exp(0.02 * T), df = exp(-0.05 * T);
+        double K = type == Call ? 80.0 : 120.0; //in the money
+        quote(T, K, NaN, type, 0.5 * df * fabs(forward - K), IVStatus::BelowIntrinsic);
+        quote(T, K, NaN, type, 1.01 * df * (type == Call ? forward : K), IVStatus::AboveMaximum);
+        quote(T, 100.0, NaN, type, -1.0, IVStatus::InvalidInput);
+    }
+    ImpliedVolBatch mixed{iv_T, iv_K, iv_r, iv_b, iv_S, iv_price, iv_type};
+    vector<double> iv_out(iv_price.size());
+    vector<IVStatus> iv_status(iv_price.size());
+    for (int level = 0; level <= (int)simd::DetectSimdLevel(); level++){
+        ImpliedVolSolver((simd::SimdLevel)level).Compute(mixed, ImpliedVolResult{iv_out, iv_status});
+        double max_err = 0.0;
+        bool ok = true;
+        for (size_t i = 0; i < iv_out.size(); i++){
+            ok = ok && iv_status[i] == iv_expected[i];
+            if (iv_expected[i] == IVStatus::Converged)
+                max_err = max(max_err, fabs(iv_out[i] - iv_sig[i]) / iv_sig[i]);
+            else
+                ok = ok && isnan(iv_out[i]);
+        }
+        ok = ok && max_err <= 1e-9; // also false for a NaN
+        failures += ok ? 0 : 1;
+        cout << "SIMD level " << level << " " << iv_out.size() << " calls and puts, max relative |implied vol - sig| = " << max_err
+             << (ok ? ", statuses as expected" : "  FAILED") << endl;
+    }
+
+    //g) round trip through the column and csv files, pricing straight from the mapping
+    string dir = filesystem::temp_directory_path().string();
+    ParameterFile::Write(dir + "/parameters.col", batch);
+    {
+        ParameterFile parameters(dir + "/parameters.col");
+        ResultFile results = ResultFile::Create(dir + "/results.col", parameters.Rows());
+        EuropeanBatchPricer().Compute(parameters.Batch(), results.Result());
+        ExportCsv(dir + "/results.csv", parameters.Batch(), results.Price(), results.Delta(), results.Gamma());
+    }
+    ImportCsv(dir + "/results.csv", dir + "/imported.col");
+    ParameterFile imported(dir + "/imported.col");
+    ResultFile results(dir + "/results.col");
+    double max_err = 0.0;
+    for (size_t i = 0; i < parameter_matrix.size(); i++){
+        max_err = max(max_err, fabs(results.Price()[i] - simd_prices[i]));
+        max_err = max(max_err, fabs(imported.Batch().S[i] - parameter_matrix[i][5]));
+    }
+    cout << imported.Rows() << " rows through the files, max difference = " << max_err << endl;
+    for (const char* name : {"/parameters.col", "/results.col", "/results.csv", "/imported.col"})
+        filesystem::remove(dir + name);
+    cout << endl;
+
     //Option Sensitivities, aka the Greeks
     //a)
     EuropeanOption Option(0.5, 100, 0.36, 0.1, 0, 105, "C");
-    cout << "Call Option Delta: " << Option.Delta() << " Gamma: " << Option.Gamma() <<endl;
-    Option.toggle();
-    cout << "Put Option Delta: " << Option.Delta() << " Gamma: " << Option.Gamma() <<endl;
+    //evaluate both sides and all greeks in one pass
+    OptionValues values = Option.Evaluate();
+    cout << "Call Option Delta: " << values.callDelta << " Gamma: " << values.gamma <<endl;
+    cout << "Put Option Delta: " << values.putDelta << " Gamma: " << values.gamma <<endl;
+    cout << "Vega: " << values.vega << " Call Theta: " << values.callTheta << " Put Theta: " << values.putTheta
+         << " Call Rho: " << values.callRho << " Put Rho: " << values.putRho << endl;
+    Option.toggle(); //the parts below work on the put
     
     //b)
     vector<double> delta_values;
@@ -150,6 +618,11 @@ int main(int argc, const char * argv[]) {
     }
     
     
+    //every bumped sensitivity, both schemes and the batch engine, against the closed form
+    int fd_failures = CheckFiniteDifferenceGreeks(parameter_matrix);
+    failures += fd_failures;
+    cout << endl;
+
     //B. Perpetual American Options
     //a) implemented in PerpetualAmericanOption class
     //b) Test on specific data
@@ -166,6 +639,24 @@ int main(int argc, const char * argv[]) {
         cout << "S=" << *it << "   Price=" << a_option.Price() <<endl;
         a_prices.push_back(a_option.Price());
     }
+
+    //the same sweep twice through a pricing cache, the second pass is all hits
+    PricingCache cache(1024);
+    PerpetualAmericanOption::SetPricingCache(&cache);
+    double cached_err = 0.0;
+    for (int pass = 0; pass < 2; pass++){
+        for (size_t i = 0; i < S_values.size(); i++){
+            a_option.setS(S_values[i]);
+            cached_err = max(cached_err, fabs(a_option.Price() / a_prices[i] - 1.0));
+        }
+    }
+    PerpetualAmericanOption::SetPricingCache(nullptr);
+    PricingCacheStats stats = cache.Stats();
+    bool cached_ok = stats.hits == S_values.size() && stats.misses == S_values.size() && cached_err <= 1e-12; // also false for a NaN
+    failures += cached_ok ? 0 : 1;
+    cout << "Cached sweep: hits " << stats.hits << " misses " << stats.misses << " max |cached / direct - 1| = " << cached_err
+         << (cached_ok ? "" : "  FAILED") << endl;
+    failures += CheckPricingCache(S_values);
     
     //d)
     vector<vector<double>> parameter_matrix2;
@@ -185,7 +676,101 @@ int main(int argc, const char * argv[]) {
     a_option_matrix.toggle();
     a_option_matrix.PriceWithMatrix();
     a_option_matrix.PrintPriceResult();
-    
+    failures += CheckPerpetualBatch(parameter_matrix2, S_values);
 
-    
+    //both matrices, both types, on one spot x vol x time grid against Price(), Delta() and Gamma(),
+    //once into columns and once through a sink; the short option rolls to expiry on the time axis
+    vector<ScenarioOption> grid_options;
+    for (OptionType type : {Call, Put}){
+        for (vector<double>& row : parameter_matrix)
+            grid_options.push_back({OptionParameters{row[0], row[1], row[2], row[3], row[4], row[5], type}, PricingModel::European});
+        for (vector<double>& row : parameter_matrix2)
+            grid_options.push_back({OptionParameters{0.0, row[0], row[1], row[2], row[3], row[4], type}, PricingModel::PerpetualAmerican});
+        grid_options.push_back({OptionParameters{0.5, 100.0, 0.25, 0.05, 0.02, 100.0, type}, PricingModel::European});
+    }
+    ScenarioAxes grid;
+    grid.S = ScenarioAxis{{0.5, 0.8, 0.95, 1.0, 1.05, 1.2, 2.0}, AxisKind::Shift};
+    grid.sig = ScenarioAxis{{-0.1, 0.0, 0.15}, AxisKind::Shift};
+    grid.T = ScenarioAxis{{-0.5, 0.0, 0.75}, AxisKind::Shift};
+    size_t nS = grid.S.size(), nSig = grid.sig.size(), nT = grid.T.size(), points = grid_options.size() * grid.Points();
+    vector<double> grid_price(points), grid_delta(points), grid_gamma(points);
+    vector<double> sink_price(points), sink_delta(points), sink_gamma(points);
+    ScenarioGridEngine engine;
+    engine.Compute(grid_options, grid, ScenarioResult{grid_price, grid_delta, grid_gamma});
+    engine.Compute(grid_options, grid, [&](const ScenarioLine& line){ //lines are disjoint, no lock needed
+        size_t offset = ((line.option * nT + line.t) * nSig + line.v) * nS;
+        copy(line.price.begin(), line.price.end(), sink_price.begin() + offset);
+        copy(line.delta.begin(), line.delta.end(), sink_delta.begin() + offset);
+        copy(line.gamma.begin(), line.gamma.end(), sink_gamma.begin() + offset);
+    }, true);
+    double grid_err = 0.0;
+    for (size_t o = 0; o < grid_options.size(); o++){
+        for (size_t t = 0; t < nT; t++){
+            for (size_t v = 0; v < nSig; v++){
+                for (size_t i = 0; i < nS; i++){
+                    OptionParameters p = grid_options[o].p;
+                    p.S *= grid.S.values[i];
+                    p.sig += grid.sig.values[v];
+                    p.T += grid.T.values[t];
+                    double price, delta, gamma;
+                    if (grid_options[o].model == PricingModel::PerpetualAmerican){
+                        PerpetualAmericanOption option(p.K, p.sig, p.r, p.b, p.S, p.type);
+                        const PerpetualInvariants& inv = option.Invariants();
+                        price = option.Price();
+                        delta = inv.degenerate ? 1.0 : inv.y * price / p.S;
+                        gamma = inv.degenerate ? 0.0 : (inv.y - 1.0) * delta / p.S;
+                    } else if (p.T == 0.0){ //expired, the payoff
+                        double w = p.type;
+                        price = max(w * (p.S - p.K), 0.0);
+                        delta = price > 0.0 ? w : 0.0;
+                        gamma = 0.0;
+                    } else {
+                        EuropeanOption option(p.T, p.K, p.sig, p.r, p.b, p.S, p.type);
+                        price = option.Price();
+                        delta = option.Delta();
+                        gamma = option.Gamma();
+                    }
+                    size_t k = ((o * nT + t) * nSig + v) * nS + i;
+                    for (double value : {grid_price[k], sink_price[k]})
+                        grid_err = max(grid_err, fabs(value - price) / max(1.0, fabs(price)));
+                    for (double value : {grid_delta[k], sink_delta[k]})
+                        grid_err = max(grid_err, fabs(value - delta) / max(1.0, fabs(delta)));
+                    for (double value : {grid_gamma[k], sink_gamma[k]})
+                        grid_err = max(grid_err, fabs(value - gamma) / max(1.0, fabs(gamma)));
+                }
+            }
+        }
+    }
+    bool grid_ok = grid_err <= 1e-12; // also false for a NaN
+    failures += grid_ok ? 0 : 1;
+    cout << "Scenario grid of " << points << " points, max relative |grid - closed form| = " << grid_err
+         << (grid_ok ? "" : "  FAILED") << endl;
+
+    //C. Both matrices as one book, 100 calls each on two underlyings, perpetual puts short 50
+    Portfolio book;
+    for (vector<double>& row : parameter_matrix)
+        book.Add(Position{"SPX", OptionParameters{row[0], row[1], row[2], row[3], row[4], row[5], Call}, PricingModel::European, 100.0});
+    for (vector<double>& row : parameter_matrix2)
+        book.Add(Position{"NDX", OptionParameters{0.0, row[0], row[1], row[2], row[3], row[4], Put}, PricingModel::PerpetualAmerican, -50.0});
+    book.Revalue();
+    for (const BucketRisk& bucket : book.Buckets())
+        cout << bucket.underlying << " expiry bucket " << bucket.expiry << ": PV " << bucket.risk.pv << " delta " << bucket.risk.delta
+             << " gamma " << bucket.risk.gamma << " vega " << bucket.risk.vega << endl;
+    cout << "Book PV " << book.Total().pv << " delta " << book.Total().delta << endl;
+    book.SetSpot("NDX", 100.0); //one tick revalues only the blocks holding NDX
+    book.Revalue();
+    cout << "Book PV after NDX at 100: " << book.Total().pv << " delta " << book.Total().delta << endl;
+    int book_failures = CheckIncrementalBook(nullptr) + CheckIncrementalBook(&ThreadPool::Shared());
+    failures += book_failures;
+    cout << "Incremental book against a rebuilt one, serial and pooled: " << (book_failures == 0 ? "bitwise equal" : "FAILED") << endl;
+
+    //D. cached invariants against the closed form after every constructor and setter
+    int invariant_failures = CheckInvariants();
+    failures += invariant_failures;
+    cout << "Invariant checks: " << (invariant_failures == 0 ? "passed" : "FAILED") << endl;
+
+    //counters and timers of the batch engines, empty unless built with PRICING_METRICS=1
+    if (metrics::enabled)
+        cout << endl << metrics::snapshot().text();
+    return failures > 0 ? 1 : 0;
 }
@@ -0,0 +1,66 @@
+// BrownianBridge.cpp
+//
+// Brownian bridge construction.
+//
+// Hanlin Yan
+// Oct 18 2026
+//
+
+#include "BrownianBridge.hpp"
+#include <cmath>
+
+BrownianBridge::BrownianBridge(const std::vector<double>& t)
+{
+    long N = long(t.size()) - 1;
+    bridgeIndex.resize(N); leftIndex.resize(N); rightIndex.resize(N);
+    leftWeight.resize(N); rightWeight.resize(N); stdDev.resize(N);
+    invSqrtDt.resize(N);
+    N_ = N;
+
+    // time[i] is the time of path point i, the points are t_1..t_N
+    std::vector<double> time(t.begin() + 1, t.end());
+    for (long i = 0; i < N; ++i)
+        invSqrtDt[i] = 1.0 / sqrt(t[i + 1] - t[i]);
+
+    std::vector<long> map(N, 0);  // construction step + 1 of each point, 0 when not yet built
+    map[N - 1] = 1;
+    bridgeIndex[0] = N - 1;
+    stdDev[0] = sqrt(time[N - 1]);
+    leftWeight[0] = rightWeight[0] = 0.0;
+
+    for (long i = 1, j = 0; i < N; ++i)
+    {
+        while (map[j]) ++j;         // first point not yet built
+        long k = j;
+        while (!map[k]) ++k;        // next built point to its right
+        long l = j + ((k - 1 - j) >> 1);
+
+        map[l] = i + 1;
+        bridgeIndex[i] = l;
+        leftIndex[i] = j;
+        rightIndex[i] = k;
+        double left = j == 0 ? 0.0 : time[j - 1];
+        leftWeight[i] = (time[k] - time[l]) / (time[k] - left);
+        rightWeight[i] = (time[l] - left) / (time[k] - left);
+        stdDev[i] = sqrt((time[l] - left) * (time[k] - time[l]) / (time[k] - left));
+
+        j = k + 1;
+        if (j >= N) j = 0;
+    }
+}
+
+void BrownianBridge::increments(const double* z, double* dW) const
+{ // Build W(t_j) in dW, then difference in place from the back
+    long N = size();
+    dW[N - 1] = stdDev[0] * z[0];
+    for (long i = 1; i < N; ++i)
+    {
+        long j = leftIndex[i], k = rightIndex[i], l = bridgeIndex[i];
+        double left = j == 0 ? 0.0 : dW[j - 1];
+        dW[l] = leftWeight[i] * left + rightWeight[i] * dW[k] + stdDev[i] * z[i];
+    }
+
+    for (long i = N - 1; i > 0; --i)
+        dW[i] = (dW[i] - dW[i - 1]) * invSqrtDt[i];
+    dW[0] *= invSqrtDt[0];
+}
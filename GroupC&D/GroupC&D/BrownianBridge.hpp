@@ -0,0 +1,37 @@
+// BrownianBridge.hpp
+//
+// Brownian bridge construction over an arbitrary time mesh (Jackel). The
+// first normal fixes W at the last time, the next ones fill the midpoints of
+// the remaining gaps, so with QMC input the low, well distributed dimensions
+// decide the large-scale shape of the path.
+//
+// Hanlin Yan
+// Oct 18 2026
+//
+
+#ifndef BrownianBridge_HPP
+#define BrownianBridge_HPP
+
+#include <vector>
+
+class BrownianBridge
+{
+private:
+    std::vector<long> bridgeIndex, leftIndex, rightIndex;
+    std::vector<double> leftWeight, rightWeight, stdDev;
+    std::vector<double> invSqrtDt;      // 1 / sqrt(t_j - t_{j-1})
+    long N_;                            // number of steps
+
+public:
+    // t is the time mesh t_0 = 0 < t_1 < ... < t_N, as returned by Range<double>::mesh
+    BrownianBridge(const std::vector<double>& t);
+
+    long size() const { return N_; }
+
+    // N normals in construction order to N standardised increments
+    // (W(t_j) - W(t_{j-1})) / sqrt(t_j - t_{j-1}), the input of the Euler step.
+    // Const and without scratch state, so one bridge serves every thread.
+    void increments(const double* z, double* dW) const;
+};
+
+#endif
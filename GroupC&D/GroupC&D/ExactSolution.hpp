@@ -0,0 +1,48 @@
+// ExactSolution.hpp
+//
+// Black-Scholes closed form for the MC control variate: the discounted
+// payoff of exact GBM driven by the same normals as the simulated path has
+// this price as its known mean. The down-and-out call is the reference for
+// the FDM barrier option.
+//
+// Hanlin Yan
+// Oct 18 2026
+//
+
+#ifndef ExactSolution_HPP
+#define ExactSolution_HPP
+
+#include "OptionData.hpp"
+#include <cmath>
+#include <boost/math/distributions/normal.hpp>
+
+inline double BlackScholesPrice(const OptionData& data, int type)
+{ // type 1 == call, -1 == put; no dividend, b = r
+    boost::math::normal_distribution<> N(0.0, 1.0);
+
+    double tmp = data.sig * sqrt(data.T);
+    double d1 = (log(data.S / data.K) + (data.r + 0.5 * data.sig * data.sig) * data.T) / tmp;
+    double d2 = d1 - tmp;
+
+    return type * (data.S * cdf(N, type * d1) - data.K * exp(-data.r * data.T) * cdf(N, type * d2));
+}
+
+inline double DownAndOutCallPrice(const OptionData& data)
+{ // Merton / Reiner-Rubinstein, barrier data.H <= K, no rebate, dividend yield data.D
+  //      C_do(S) = C(S) - (H / S)^(2 lambda - 2) C(H^2 / S),  lambda = (r - D) / sig^2 + 0.5
+    if (data.S <= data.H)
+        return 0.0;
+    boost::math::normal_distribution<> N(0.0, 1.0);
+
+    double tmp = data.sig * sqrt(data.T);
+    auto call = [&](double S)
+    {
+        double d1 = (log(S / data.K) + (data.r - data.D + 0.5 * data.sig * data.sig) * data.T) / tmp;
+        return S * exp(-data.D * data.T) * cdf(N, d1) - data.K * exp(-data.r * data.T) * cdf(N, d1 - tmp);
+    };
+    double lambda = (data.r - data.D) / (data.sig * data.sig) + 0.5;
+
+    return call(data.S) - pow(data.H / data.S, 2.0 * lambda - 2.0) * call(data.H * data.H / data.S);
+}
+
+#endif
@@ -0,0 +1,284 @@
+// FDMEngine.cpp
+//
+// Theta scheme with Rannacher start, Thomas / Brennan-Schwartz / PSOR solves,
+// uniform or sinh meshes with the strike on a node, greeks from the grid.
+//
+// Hanlin Yan
+// Oct 18 2026
+//
+
+#include "FDMEngine.hpp"
+#include "Range.cpp"
+#include "Metrics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+FDMEngine::FDMEngine(const FDMSettings& settings)
+    : settings(settings), factoredThetaK(std::numeric_limits<double>::quiet_NaN())
+{
+    if (settings.extrapolate && settings.NS % 2 != 0)
+        throw std::invalid_argument("FDMEngine: extrapolation needs an even NS");
+}
+
+void FDMEngine::buildOperator(const OptionData& data)
+{ // Three point differences, valid on a non-uniform mesh
+    long NS = long(S.size()) - 1;
+    l.assign(NS + 1, 0.0);
+    d.assign(NS + 1, 0.0);
+    u.assign(NS + 1, 0.0);
+
+    for (long i = 1; i < NS; ++i)
+    {
+        double hm = S[i] - S[i-1], hp = S[i+1] - S[i];
+        double alpha = 0.5 * data.sig * data.sig * S[i] * S[i];    // diffusion
+        double beta = (data.r - data.D) * S[i];                     // convection
+
+        l[i] = (2.0 * alpha - beta * hp) / (hm * (hm + hp));
+        u[i] = (2.0 * alpha + beta * hm) / (hp * (hm + hp));
+        d[i] = (beta * (hp - hm) - 2.0 * alpha) / (hm * hp) - data.r;
+    }
+}
+
+void FDMEngine::buildMatrix(double thetaK, bool reverse)
+{
+    long n = long(S.size());
+    a.resize(n);
+    b.resize(n);
+    c.resize(n);
+    for (long i = 0; i < n; ++i)
+    { // The boundary rows of l, d, u are zero, which leaves them as identity rows
+        a[i] = -thetaK * l[i];
+        b[i] = 1.0 - thetaK * d[i];
+        c[i] = -thetaK * u[i];
+    }
+    solver.factor(a.data(), b.data(), c.data(), n, reverse);
+    factoredThetaK = thetaK;
+}
+
+void FDMEngine::boundaries(const OptionData& data, ExerciseStyle style, double t,
+                           double& low, double& high) const
+{ // Option values at the lower end (0 or the barrier) and at S_max, t time to expiry
+    double SMax = S.back();
+    double discount = exp(-data.r * t);
+    if (data.type == 1)
+    {
+        low = 0.0;
+        high = SMax * exp(-data.D * t) - data.K * discount;
+        if (style == ExerciseStyle::American)
+            high = std::max(high, SMax - data.K);
+    }
+    else
+    {
+        low = style == ExerciseStyle::American ? data.K : data.K * discount;
+        high = 0.0;
+    }
+    if (settings.downAndOut)
+        low = 0.0;
+}
+
+long FDMEngine::step(const OptionData& data, ExerciseStyle style, double t, double k, double theta, bool reverse)
+{ // V at the previous level to V at time to expiry t
+    long NS = long(S.size()) - 1;
+    double explicitK = (1.0 - theta) * k;
+    for (long i = 1; i < NS; ++i)
+        rhs[i] = V[i] + explicitK * (l[i] * V[i-1] + d[i] * V[i] + u[i] * V[i+1]);
+    boundaries(data, style, t, rhs[0], rhs[NS]);
+
+    double thetaK = theta * k;
+    if (thetaK != factoredThetaK)
+        buildMatrix(thetaK, reverse);
+
+    if (style == ExerciseStyle::European)
+        solver.solve(rhs.data(), V.data());
+    else if (settings.exercise == EarlyExercise::BrennanSchwartz)
+        solver.solveProjected(rhs.data(), payoff.data(), V.data());
+    else
+        return psor();
+    return 0;
+}
+
+long FDMEngine::psor()
+{ // Projected SOR on (a, b, c) V = rhs, V >= payoff, starting from the previous level
+    long NS = long(S.size()) - 1;
+    V[0] = rhs[0];
+    V[NS] = rhs[NS];
+
+    long sweeps = 0;
+    double change = settings.tolerance + 1.0;
+    while (change > settings.tolerance && sweeps < settings.maxIterations)
+    {
+        change = 0.0;
+        for (long i = 1; i < NS; ++i)
+        {
+            double y = (rhs[i] - a[i] * V[i-1] - c[i] * V[i+1]) / b[i];
+            double next = std::max(V[i] + settings.omega * (y - V[i]), payoff[i]);
+            change = std::max(change, std::abs(next - V[i]));
+            V[i] = next;
+        }
+        sweeps++;
+    }
+    return sweeps;
+}
+
+long FDMEngine::weights(double x, double w[3], double w1[3], double w2[3]) const
+{ // Lagrange weights of the three nodes around x for the value and the first
+  // two derivatives of the quadratic through them; returns the middle node
+    long NS = long(S.size()) - 1;
+    long i = long(std::upper_bound(S.begin(), S.end(), x) - S.begin()) - 1;
+    if (i < NS && S[i+1] - x < x - S[i])
+        i++;
+    i = std::min(std::max(i, 1L), NS - 1);
+
+    double x0 = S[i-1], x1 = S[i], x2 = S[i+1];
+    double q0 = 1.0 / ((x0 - x1) * (x0 - x2));
+    double q1 = 1.0 / ((x1 - x0) * (x1 - x2));
+    double q2 = 1.0 / ((x2 - x0) * (x2 - x1));
+
+    w[0] = (x - x1) * (x - x2) * q0;
+    w[1] = (x - x0) * (x - x2) * q1;
+    w[2] = (x - x0) * (x - x1) * q2;
+    w1[0] = (2.0 * x - x1 - x2) * q0;
+    w1[1] = (2.0 * x - x0 - x2) * q1;
+    w1[2] = (2.0 * x - x0 - x1) * q2;
+    w2[0] = 2.0 * q0;
+    w2[1] = 2.0 * q1;
+    w2[2] = 2.0 * q2;
+    return i;
+}
+
+void FDMEngine::buildGrid(const OptionData& data, long coarsen)
+{ // Uniform or sinh mesh on [low, S_max] with the strike on a node. The mesh
+  // is laid out for settings.NS and keeps every coarsen-th node, so the meshes
+  // of an extrapolated solve are nested.
+    long NS = settings.NS;
+    long step = settings.extrapolate ? 2 : 1;   // the strike node must survive coarsening
+    double low = settings.downAndOut ? data.H : 0.0;
+    double SMax = std::max(data.S, data.K) * exp(settings.width * data.sig * sqrt(data.T));
+    bool strikeInside = data.K > low && data.K < SMax;
+    auto strikeNode = [&](double fraction)
+    { // Nearest usable node index to the given fraction of the mesh
+        long j = step * lround(fraction * double(NS) / double(step));
+        return std::min(std::max(j, step), NS - step);
+    };
+
+    if (settings.clustering <= 0.0)
+    {
+        long j = 0;
+        if (strikeInside)
+        { // Stretch S_max so that the spacing divides K - low
+            j = strikeNode((data.K - low) / (SMax - low));
+            SMax = low + (data.K - low) * double(NS) / double(j);
+        }
+        Range<double>(low, SMax).mesh(NS / coarsen, S);
+        if (strikeInside)
+            S[j / coarsen] = data.K;
+        return;
+    }
+
+    double alpha = data.K / settings.clustering;
+    double c1 = asinh((low - data.K) / alpha);
+    double c2 = asinh((SMax - data.K) / alpha);
+    long j = 0;
+    if (strikeInside)
+    { // Move c2 so that xi = j / NS maps exactly to K
+        j = strikeNode(-c1 / (c2 - c1));
+        c2 = c1 * (1.0 - double(NS) / double(j));
+    }
+
+    Range<double>(0.0, 1.0).mesh(NS / coarsen, S);
+    for (long i = 0; i <= NS / coarsen; ++i)
+        S[i] = data.K + alpha * sinh(c1 + (c2 - c1) * S[i]);
+    S[0] = low;
+    if (strikeInside)
+        S[j / coarsen] = data.K;
+}
+
+FDMResult FDMEngine::price(const OptionData& data, ExerciseStyle style)
+{
+    metrics::count(metrics::Engine::FDM, metrics::Counter::OptionsPriced, 1);
+    if (settings.downAndOut && data.S <= data.H)
+        return FDMResult{ 0.0, 0.0, 0.0, 0.0, 0 };    // knocked out, the mesh does not reach S
+    if (!settings.extrapolate)
+        return solve(data, style, 1);
+
+    // Richardson: the spatial error is c h^2, so (4 fine - coarse) / 3 cancels it
+    FDMResult coarse = solve(data, style, 2);
+    FDMResult fine = solve(data, style, 1);
+    FDMResult result;
+    result.price = (4.0 * fine.price - coarse.price) / 3.0;
+    result.delta = (4.0 * fine.delta - coarse.delta) / 3.0;
+    result.gamma = (4.0 * fine.gamma - coarse.gamma) / 3.0;
+    result.theta = (4.0 * fine.theta - coarse.theta) / 3.0;
+    result.iterations = coarse.iterations + fine.iterations;
+    return result;
+}
+
+FDMResult FDMEngine::solve(const OptionData& data, ExerciseStyle style, long coarsen)
+{
+    {
+        metrics::ScopedTimer timer(metrics::Engine::FDM, metrics::Phase::Setup);
+        buildGrid(data, coarsen);
+        Range<double>(0.0, data.T).mesh(settings.NT, tau);
+
+        long n = long(S.size());
+        V.resize(n);
+        VPrev.resize(n);
+        payoff.resize(n);
+        rhs.resize(n);
+        for (long i = 0; i < n; ++i)
+            payoff[i] = data.type == 1 ? std::max(S[i] - data.K, 0.0) : std::max(data.K - S[i], 0.0);
+        if (settings.downAndOut)
+            payoff[0] = 0.0;    // knocked out, nothing to exercise at the barrier
+        std::copy(payoff.begin(), payoff.end(), V.begin());
+
+        buildOperator(data);
+        factoredThetaK = std::numeric_limits<double>::quiet_NaN();
+    }
+
+    // Brennan-Schwartz back substitutes from the exercise region, low S for a put
+    bool reverse = style == ExerciseStyle::American && data.type != 1;
+
+    // One step size, so the matrix is factored once for the Rannacher steps
+    // and once for the rest
+    double k = data.T / double(settings.NT);
+
+    FDMResult result;
+    result.iterations = 0;
+    double lastK = k;
+    metrics::count(metrics::Engine::FDM, metrics::Counter::TimeSteps, settings.NT + std::min(settings.rannacherSteps, settings.NT));
+    for (long m = 1; m <= settings.NT; ++m)
+    {
+        metrics::ScopedTimer timer(metrics::Engine::FDM, metrics::Phase::Stepping);
+        if (m <= settings.rannacherSteps)
+        {
+            result.iterations += step(data, style, tau[m-1] + 0.5 * k, 0.5 * k, 1.0, reverse);
+            if (m == settings.NT)
+            {
+                std::copy(V.begin(), V.end(), VPrev.begin());
+                lastK = 0.5 * k;
+            }
+            result.iterations += step(data, style, tau[m], 0.5 * k, 1.0, reverse);
+        }
+        else
+        {
+            if (m == settings.NT)
+                std::copy(V.begin(), V.end(), VPrev.begin());
+            result.iterations += step(data, style, tau[m], k, settings.theta, reverse);
+        }
+    }
+
+    // Price and greeks from the three nodes around S
+    double w[3], w1[3], w2[3];
+    long i = weights(data.S, w, w1, w2);
+    result.price = result.delta = result.gamma = result.theta = 0.0;
+    for (long j = 0; j < 3; ++j)
+    {
+        result.price += w[j] * V[i-1+j];
+        result.delta += w1[j] * V[i-1+j];
+        result.gamma += w2[j] * V[i-1+j];
+        result.theta -= w[j] * (V[i-1+j] - VPrev[i-1+j]) / lastK;
+    }
+    return result;
+}
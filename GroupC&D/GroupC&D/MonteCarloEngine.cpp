@@ -0,0 +1,463 @@
+// MonteCarloEngine.cpp
+//
+// Parallel Monte Carlo pricer, block scheduling and payoff statistics.
+//
+// Hanlin Yan
+// Oct 18 2026
+//
+
+#include "MonteCarloEngine.hpp"
+#include "ExactSolution.hpp"
+#include "SobolSequence.hpp"
+#include "Metrics.hpp"
+#include "Range.cpp"
+#include <atomic>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+static unsigned long long splitMix64(unsigned long long z)
+{ // Decorrelate the block seeds
+    z += 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+void MonteCarloEngineBase::BlockStats::merge(const BlockStats& s)
+{
+    callPlain.merge(s.callPlain); putPlain.merge(s.putPlain);
+    call.merge(s.call); put.merge(s.put);
+    callCV.merge(s.callCV); putCV.merge(s.putCV);
+    hitsOrigin += s.hitsOrigin;
+}
+
+static double varianceReductionFactor(const RunningStatistics& plain, const RunningStatistics& sample)
+{ // Plain variance over the estimator variance, both per simulated path; undefined (NaN) for a zero estimator variance
+    double pathsPerSample = double(plain.count()) / double(sample.count());
+    double v = sample.variance() * pathsPerSample;
+    return v > 0.0 ? plain.variance() / v : std::numeric_limits<double>::quiet_NaN();
+}
+
+static const long Lanes = 4;    // partial sums per reduction, so the sweeps vectorize in a fixed order
+
+template <class F>
+static double columnSum(long n, F term)
+{ // Sum of term(i) over [0, n), the lanes are added the same way on every build
+    double s[Lanes] = {};
+    long i = 0;
+    for (; i + Lanes <= n; i += Lanes)
+        for (long j = 0; j < Lanes; ++j)
+            s[j] += term(i + j);
+    for (; i < n; ++i)
+        s[i % Lanes] += term(i);
+    return (s[0] + s[1]) + (s[2] + s[3]);
+}
+
+static RunningStatistics columnStatistics(const double* y, long n)
+{ // Two passes over a column: the mean, then the squared deviations
+    if (n == 0) return RunningStatistics();
+    double mean = columnSum(n, [&](long i) { return y[i]; }) / double(n);
+    double m2 = columnSum(n, [&](long i) { double d = y[i] - mean; return d * d; });
+    return RunningStatistics(n, mean, m2);
+}
+
+static RunningCovariance columnCovariance(const double* y, const double* x, long n)
+{ // Two passes over a pair of columns (Y, X)
+    if (n == 0) return RunningCovariance();
+    double meanY = columnSum(n, [&](long i) { return y[i]; }) / double(n);
+    double meanX = columnSum(n, [&](long i) { return x[i]; }) / double(n);
+    double m2Y = columnSum(n, [&](long i) { double d = y[i] - meanY; return d * d; });
+    double m2X = columnSum(n, [&](long i) { double d = x[i] - meanX; return d * d; });
+    double cXY = columnSum(n, [&](long i) { return (x[i] - meanX) * (y[i] - meanY); });
+    return RunningCovariance(n, meanY, meanX, m2Y, m2X, cXY);
+}
+
+static void knockOut(const double* __restrict X, double* __restrict alive, double barrier, long n)
+{ // Clear the mask of the paths at or below the barrier, a branch-free blend
+    for (long i = 0; i < n; ++i)
+        alive[i] = X[i] > barrier ? alive[i] : 0.0;
+}
+
+MonteCarloEngineBase::MonteCarloEngineBase(const OptionData& data, const MCSettings& settings)
+    : data(data), settings(settings)
+{
+    if (settings.NSim < 2)
+        throw std::invalid_argument("MonteCarloEngine: NSim must be at least 2 for a variance");
+    if (settings.NT < 1)
+        throw std::invalid_argument("MonteCarloEngine: NT must be at least 1");
+    if (settings.nThreads < 0)
+        throw std::invalid_argument("MonteCarloEngine: nThreads must be at least 1, or 0 for every hardware thread");
+    if (this->settings.nThreads == 0)
+        this->settings.nThreads = int(std::max(1u, std::thread::hardware_concurrency()));
+    if (settings.method == NormalMethod::Sobol && settings.reduction == VarianceReduction::MomentMatching)
+        throw std::invalid_argument("MonteCarloEngine: moment matching would destroy the Sobol point structure");
+}
+
+MonteCarloEngineBase::BlockStats MonteCarloEngineBase::simulateBlock(const std::vector<double>& x,
+                                                                     const BrownianBridge* bridge, long count,
+                                                                     unsigned long blockSeed, long firstPoint) const
+{
+    const long NSteps = long(x.size()) - 1;
+    metrics::BlockTimers timers(metrics::Engine::MonteCarlo);   // per path scopes, merged once when the block ends
+    std::unique_ptr<NormalGenerator> myNormal;
+    {
+        metrics::ScopedTimer timer(timers, metrics::Phase::Setup);
+        if (settings.method == NormalMethod::Sobol)
+            myNormal = std::make_unique<SobolNormal>(NSteps, blockSeed, std::uint32_t(firstPoint));
+        else
+            myNormal = createNormalGenerator(settings.method, blockSeed);
+    }
+
+    if (settings.lockstep)
+        return simulateLockstep(x, bridge, *myNormal, count, timers);
+
+    std::vector<double> z(bridge != nullptr ? NSteps : 0);
+    auto draw = [&](double* dW)
+    { // Standardised increments of one path
+        metrics::ScopedTimer timer(timers, metrics::Phase::Rng);
+        if (bridge == nullptr)
+            return myNormal->fill(dW, NSteps);
+        myNormal->fill(z.data(), NSteps);
+        bridge->increments(z.data(), dW);
+    };
+
+    double df = exp(-data.r * data.T);
+    BlockStats stats;
+
+    if (settings.reduction == VarianceReduction::MomentMatching)
+    { // Draw the whole block, then match the first two moments of every step
+        std::vector<double> dW(count * NSteps);
+        for (long i = 0; i < count; ++i)
+            draw(&dW[i * NSteps]);
+        for (long j = 0; count > 1 && j < NSteps; ++j)
+        {
+            RunningStatistics column;
+            for (long i = 0; i < count; ++i)
+                column.add(dW[i * NSteps + j]);
+            double scale = 1.0 / column.SD();
+            for (long i = 0; i < count; ++i)
+                dW[i * NSteps + j] = (dW[i * NSteps + j] - column.mean()) * scale;
+        }
+
+        for (long i = 0; i < count; ++i)
+        {
+            double VNew;
+            bool out;
+            {
+                metrics::ScopedTimer timer(timers, metrics::Phase::Stepping);
+                VNew = simulatePath(x, &dW[i * NSteps], 1.0, stats.hitsOrigin, out);
+            }
+            double call = out ? 0.0 : df * max(VNew - data.K, 0.0);
+            double put = out ? 0.0 : df * max(data.K - VNew, 0.0);
+            stats.callPlain.add(call);
+            stats.putPlain.add(put);
+        }
+        return stats;   // the sample is set from the block mean in run()
+    }
+
+    std::vector<double> dW(NSteps);     // increments of one path
+    long samples = settings.reduction == VarianceReduction::Antithetic ? (count + 1) / 2 : count;
+    double drift = (data.r - 0.5 * data.sig * data.sig) * data.T;
+    double vol = data.sig * sqrt(data.T / double(NSteps));
+
+    for (long i = 0; i < samples; ++i)
+    { // Calculate a path (or pair) at each iteration
+        draw(dW.data());
+        double VNew, VAnti = 0.0;
+        bool out, outAnti = false;
+        {
+            metrics::ScopedTimer timer(timers, metrics::Phase::Stepping);
+            VNew = simulatePath(x, dW.data(), 1.0, stats.hitsOrigin, out);
+            if (settings.reduction == VarianceReduction::Antithetic)
+                VAnti = simulatePath(x, dW.data(), -1.0, stats.hitsOrigin, outAnti);
+        }
+        metrics::ScopedTimer timer(timers, metrics::Phase::Payoff);
+
+        // Discounted payoffs
+        double call = out ? 0.0 : df * max(VNew - data.K, 0.0);
+        double put = out ? 0.0 : df * max(data.K - VNew, 0.0);
+        stats.callPlain.add(call);
+        stats.putPlain.add(put);
+
+        if (settings.reduction == VarianceReduction::Antithetic)
+        {
+            double callAnti = outAnti ? 0.0 : df * max(VAnti - data.K, 0.0);
+            double putAnti = outAnti ? 0.0 : df * max(data.K - VAnti, 0.0);
+            stats.callPlain.add(callAnti);
+            stats.putPlain.add(putAnti);
+            stats.call.add(0.5 * (call + callAnti));
+            stats.put.add(0.5 * (put + putAnti));
+        }
+        else if (settings.reduction == VarianceReduction::ControlVariate)
+        { // Exact GBM with the same Brownian increments
+            double W = 0.0;
+            for (long j = 0; j < NSteps; ++j)
+                W += dW[j];
+            double STerm = data.S * exp(drift + vol * W);
+            stats.callCV.add(call, df * max(STerm - data.K, 0.0));
+            stats.putCV.add(put, df * max(data.K - STerm, 0.0));
+        }
+    }
+    return stats;
+}
+
+MonteCarloEngineBase::BlockStats MonteCarloEngineBase::simulateLockstep(const std::vector<double>& x,
+                                                                        const BrownianBridge* bridge,
+                                                                        const NormalGenerator& myNormal,
+                                                                        long count, metrics::BlockTimers& timers) const
+{ // All paths of the block advance together, one time step at a time
+    const long NSteps = long(x.size()) - 1;
+    bool antithetic = settings.reduction == VarianceReduction::Antithetic;
+    bool control = settings.reduction == VarianceReduction::ControlVariate;
+    long n = antithetic ? (count + 1) / 2 : count;
+
+    // A bridge needs the whole Sobol point, so those paths are built up front
+    std::vector<double> paths(bridge != nullptr ? n * NSteps : 0);
+    std::vector<double> z(bridge != nullptr ? NSteps : 0);
+    for (long i = 0; bridge != nullptr && i < n; ++i)
+    {
+        myNormal.fill(z.data(), NSteps);
+        bridge->increments(z.data(), &paths[i * NSteps]);
+    }
+
+    // Path state, one entry per path
+    std::vector<double> dW(n);
+    std::vector<double> V(n, data.S);
+    std::vector<double> VAnti(antithetic ? n : 0, data.S);
+    std::vector<double> W(control ? n : 0, 0.0);    // Brownian sums for the control
+
+    // Barrier masks, 1 while the path is alive and 0 once knocked out
+    bool barrier = settings.downAndOut;
+    double alive0 = data.S > data.H ? 1.0 : 0.0;
+    std::vector<double> alive(barrier ? n : 0, alive0);
+    std::vector<double> aliveAnti(barrier && antithetic ? n : 0, alive0);
+
+    double k = data.T / double(NSteps);
+    double sqrk = sqrt(k);
+    BlockStats stats;
+
+    for (long j = 0; j < NSteps; ++j)
+    {
+        {
+            metrics::ScopedTimer timer(timers, metrics::Phase::Rng);
+            if (bridge == nullptr)
+                myNormal.fill(dW.data(), n);
+            else
+                for (long i = 0; i < n; ++i)
+                    dW[i] = paths[i * NSteps + j];
+        }
+
+        if (settings.reduction == VarianceReduction::MomentMatching && n > 1)
+        { // Match the first two moments of this step across the block
+            RunningStatistics column;
+            for (long i = 0; i < n; ++i)
+                column.add(dW[i]);
+            double mean = column.mean(), scale = 1.0 / column.SD();
+            for (long i = 0; i < n; ++i)
+                dW[i] = (dW[i] - mean) * scale;
+        }
+
+        metrics::ScopedTimer timer(timers, metrics::Phase::Stepping);
+        stats.hitsOrigin += advancePaths(x[j], k, sqrk, V.data(), dW.data(), n);
+        if (antithetic)
+            stats.hitsOrigin += advancePaths(x[j], k, -sqrk, VAnti.data(), dW.data(), n);
+        if (barrier)
+        {
+            knockOut(V.data(), alive.data(), data.H, n);
+            if (antithetic)
+                knockOut(VAnti.data(), aliveAnti.data(), data.H, n);
+        }
+        for (long i = 0; control && i < n; ++i)
+            W[i] += dW[i];
+    }
+
+    // Discounted payoffs as columns over the block, then one reduction per column
+    metrics::ScopedTimer timer(timers, metrics::Phase::Payoff);
+    std::vector<double> call(n), put(n);
+    payoffs(V.data(), barrier ? alive.data() : nullptr, n, call.data(), put.data());
+    stats.callPlain = columnStatistics(call.data(), n);
+    stats.putPlain = columnStatistics(put.data(), n);
+
+    switch (settings.reduction)
+    {
+    case VarianceReduction::Antithetic:
+    { // The sample is the pair average
+        std::vector<double> callAnti(n), putAnti(n);
+        payoffs(VAnti.data(), barrier ? aliveAnti.data() : nullptr, n, callAnti.data(), putAnti.data());
+        stats.callPlain.merge(columnStatistics(callAnti.data(), n));
+        stats.putPlain.merge(columnStatistics(putAnti.data(), n));
+        for (long i = 0; i < n; ++i)
+        {
+            callAnti[i] = 0.5 * (call[i] + callAnti[i]);
+            putAnti[i] = 0.5 * (put[i] + putAnti[i]);
+        }
+        stats.call = columnStatistics(callAnti.data(), n);
+        stats.put = columnStatistics(putAnti.data(), n);
+        break;
+    }
+    case VarianceReduction::ControlVariate:
+    { // Exact GBM with the same Brownian increments
+        double drift = (data.r - 0.5 * data.sig * data.sig) * data.T;
+        double vol = data.sig * sqrt(k);
+        std::vector<double> STerm(n), callControl(n), putControl(n);
+        for (long i = 0; i < n; ++i)
+            STerm[i] = data.S * exp(drift + vol * W[i]);
+        payoffs(STerm.data(), nullptr, n, callControl.data(), putControl.data());
+        stats.callCV = columnCovariance(call.data(), callControl.data(), n);
+        stats.putCV = columnCovariance(put.data(), putControl.data(), n);
+        break;
+    }
+    default:    // moment matching samples the block mean, set in run()
+        break;
+    }
+    return stats;
+}
+
+void MonteCarloEngineBase::payoffs(const double* __restrict V, const double* __restrict alive, long n,
+                                   double* __restrict call, double* __restrict put) const
+{ // Discounted payoffs of n terminal values, times the barrier mask when there is one
+    double df = exp(-data.r * data.T), K = data.K;
+    for (long i = 0; i < n; ++i)
+    {
+        call[i] = df * max(V[i] - K, 0.0);
+        put[i] = df * max(K - V[i], 0.0);
+    }
+    if (alive != nullptr)
+        for (long i = 0; i < n; ++i)
+        {
+            call[i] *= alive[i];
+            put[i] *= alive[i];
+        }
+}
+
+MCResult MonteCarloEngineBase::summarize(const BlockStats& total) const
+{
+    MCResult result;
+    result.hitsOrigin = total.hitsOrigin;
+    switch (settings.reduction)
+    {
+    case VarianceReduction::None:
+        result.call = total.callPlain;
+        result.put = total.putPlain;
+        break;
+    case VarianceReduction::ControlVariate:
+        result.call = total.callCV.controlled(BlackScholesPrice(data, 1));
+        result.put = total.putCV.controlled(BlackScholesPrice(data, -1));
+        break;
+    default:
+        result.call = total.call;
+        result.put = total.put;
+    }
+    result.callVRF = varianceReductionFactor(total.callPlain, result.call);
+    result.putVRF = varianceReductionFactor(total.putPlain, result.put);
+    return result;
+}
+
+MCResult MonteCarloEngineBase::run() const
+{
+    // Exact stepping needs only the value at expiry, unless the barrier is watched on the nodes
+    std::vector<double> x;
+    bool qmc = settings.method == NormalMethod::Sobol;
+    std::unique_ptr<BrownianBridge> bridge;
+    {
+        metrics::ScopedTimer timer(metrics::Engine::MonteCarlo, metrics::Phase::Setup);
+        Range<double> range(0.0, data.T);
+        x = range.mesh(settings.scheme == Scheme::ExactGBM && !settings.downAndOut ? 1 : settings.NT);
+        if (qmc)
+            bridge = std::make_unique<BrownianBridge>(x);
+    }
+
+    // QMC splits the paths into independent scrambles, each a contiguous run of points
+    long nReplicates = qmc ? Replicates : 1;
+    long perReplicate = (settings.NSim + nReplicates - 1) / nReplicates;
+    long blocksPerReplicate = (perReplicate + BlockSize - 1) / BlockSize;
+    long pointsPerBlock = settings.reduction == VarianceReduction::Antithetic ? BlockSize / 2 : BlockSize;
+
+    long nBlocks = nReplicates * blocksPerReplicate;
+    std::vector<BlockStats> blocks(nBlocks);
+    std::atomic<long> next(0);
+
+    auto worker = [&]()
+    { // Take blocks until none are left
+        for (long b = next++; b < nBlocks; b = next++)
+        {
+            long replicate = b / blocksPerReplicate, c = b % blocksPerReplicate;
+            long count = std::min(BlockSize, perReplicate - c * BlockSize);
+            unsigned long blockSeed = (unsigned long)splitMix64(settings.seed * 0x100000001ULL + (qmc ? replicate : b));
+            blocks[b] = simulateBlock(x, bridge.get(), count, blockSeed, c * pointsPerBlock);
+
+            // An antithetic block draws for half its paths and simulates each pair
+            long drawn = settings.reduction == VarianceReduction::Antithetic ? (count + 1) / 2 : count;
+            long simulated = settings.reduction == VarianceReduction::Antithetic ? 2 * drawn : count;
+            metrics::count(metrics::Engine::MonteCarlo, metrics::Counter::Paths, simulated);
+            metrics::count(metrics::Engine::MonteCarlo, metrics::Counter::TimeSteps, simulated * long(x.size() - 1));
+            metrics::count(metrics::Engine::MonteCarlo, metrics::Counter::RngDraws, drawn * long(x.size() - 1));
+            metrics::count(metrics::Engine::MonteCarlo, metrics::Counter::NegativeSpot, blocks[b].hitsOrigin);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (long t = 1; t < std::min<long>(settings.nThreads, nBlocks); ++t)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& t : threads)
+        t.join();
+
+    // Fixed order, the statistics do not depend on scheduling
+    metrics::ScopedTimer timer(metrics::Engine::MonteCarlo, metrics::Phase::Reduction);
+    auto blockMeans = [&](long first, long last, RunningStatistics BlockStats::* plain)
+    { // Moment matching: paths of one block are not independent, so the samples
+      // are the block means m_b, weighted by w_b = n_b / (average n_b). The mean
+      // is the path mean and m2 = sum w_b (m_b - mean)^2, so a short last block
+      // counts for its paths only
+        double paths = 0.0, sum = 0.0;
+        for (long b = first; b < last; ++b)
+        {
+            paths += double((blocks[b].*plain).count());
+            sum += double((blocks[b].*plain).count()) * (blocks[b].*plain).mean();
+        }
+        double mean = sum / paths, m2 = 0.0;
+        for (long b = first; b < last; ++b)
+        {
+            double d = (blocks[b].*plain).mean() - mean;
+            m2 += double((blocks[b].*plain).count()) * double(last - first) / paths * d * d;
+        }
+        return RunningStatistics(last - first, mean, m2);
+    };
+    bool matched = settings.reduction == VarianceReduction::MomentMatching;
+    if (!qmc)
+    {
+        BlockStats total;
+        for (const BlockStats& s : blocks)
+            total.merge(s);
+        if (matched)
+        {
+            total.call = blockMeans(0, nBlocks, &BlockStats::callPlain);
+            total.put = blockMeans(0, nBlocks, &BlockStats::putPlain);
+        }
+        return summarize(total);
+    }
+
+    MCResult result = MCResult();
+    BlockStats all;
+    for (long r = 0; r < nReplicates; ++r)
+    { // One estimate per scramble
+        BlockStats total;
+        for (long c = 0; c < blocksPerReplicate; ++c)
+            total.merge(blocks[r * blocksPerReplicate + c]);
+        if (matched)
+        {
+            total.call = blockMeans(r * blocksPerReplicate, (r + 1) * blocksPerReplicate, &BlockStats::callPlain);
+            total.put = blockMeans(r * blocksPerReplicate, (r + 1) * blocksPerReplicate, &BlockStats::putPlain);
+        }
+        MCResult estimate = summarize(total);
+        result.call.add(estimate.call.mean());
+        result.put.add(estimate.put.mean());
+        all.merge(total);
+    }
+    result.hitsOrigin = all.hitsOrigin;
+    result.callVRF = varianceReductionFactor(all.callPlain, result.call);
+    result.putVRF = varianceReductionFactor(all.putPlain, result.put);
+    return result;
+}
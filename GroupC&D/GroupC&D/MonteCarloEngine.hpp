@@ -0,0 +1,214 @@
+// MonteCarloEngine.hpp
+//
+// Parallel Monte Carlo pricer for one-factor SDEs, prices the call and the
+// put on the same paths. MonteCarloEngine<Model> is templated on the SDE
+// policy (see SDE.hpp), so the model inlines into the path loop; the block
+// scheduling and statistics live in the non-template MonteCarloEngineBase.
+// The time stepping scheme is chosen in MCSettings; ExactGBM takes a single
+// step to expiry whatever NT is, or NT exact steps when a barrier is monitored.
+//
+// Paths are simulated in blocks of BlockSize. Each block draws from its own
+// normal stream seeded from (seed, block index) and keeps its own streaming
+// statistics, which are merged in block order, so the result depends only on
+// the seed and not on the number of threads or on scheduling. The increments
+// of a path are drawn with one bulk fill() call.
+//
+// Variance reduction modes:
+//  Antithetic      every sample is the average of the paths driven by dW and -dW
+//  ControlVariate  the control is the discounted payoff of exact GBM driven by
+//                  the same normals, whose mean is the Black-Scholes price; the
+//                  coefficient is estimated from all paths
+//  MomentMatching  within a block the normals of each time step are shifted and
+//                  scaled to sample mean 0 and variance 1; the samples are the
+//                  block means, since paths of one block are no longer independent,
+//                  weighted by the block's path count. MCResult then holds the
+//                  statistics of about NSim / BlockSize block means (49 at the
+//                  default NSim), so SD() is not a per-path SD and the SE rests
+//                  on those few samples
+// The variance-reduction factor compares the plain per-path variance with the
+// variance of the estimator at the same number of simulated paths. It is NaN
+// (undefined) when the estimator variance is 0.
+//
+// With NormalMethod::Sobol the paths are built by a Brownian bridge from
+// scrambled Sobol points (randomized QMC). The paths are split into
+// Replicates independent scrambles, the estimator is evaluated on each one,
+// and the samples are the replicate estimates, which gives an honest SE.
+// Moment matching is not available with Sobol points.
+//
+// With MCSettings::downAndOut the option is knocked out, without rebate, on
+// the first time node with S <= data.H (discrete monitoring).
+//
+// With MCSettings::lockstep the paths of a block advance together, one time
+// step at a time, over structure-of-arrays state. The normals of a step are
+// drawn in one fill() call and the model update, the S <= 0 count and the
+// barrier mask run as branch-free loops over the paths that the compiler
+// vectorizes. At expiry the payoffs are computed as columns over the block
+// and each column is reduced in one two-pass sweep. Each
+// pseudo-random normal goes to a different path than in the path-by-path
+// loop, so the estimates differ within the statistical error. They still
+// depend only on the seed. Sobol points are assigned exactly as in the path loop.
+//
+// Hanlin Yan
+// Oct 18 2026
+//
+
+#ifndef MonteCarloEngine_HPP
+#define MonteCarloEngine_HPP
+
+#include "OptionData.hpp"
+#include "NormalGenerator.hpp"
+#include "RunningStatistics.hpp"
+#include "BrownianBridge.hpp"
+#include "SDE.hpp"
+#include "Metrics.hpp"
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+enum class VarianceReduction { None, Antithetic, ControlVariate, MomentMatching };
+
+struct MCSettings
+{
+    long NT = 100;                  // number of subintervals in time
+    long NSim = 50000;              // number of paths, antithetic runs NSim / 2 pairs
+    unsigned long seed = 0;
+    int nThreads = 0;               // 0 uses every hardware thread
+    NormalMethod method = NormalMethod::Boost;
+    VarianceReduction reduction = VarianceReduction::None;
+    Scheme scheme = Scheme::Euler;
+    bool lockstep = false;          // advance a block of paths one time step at a time
+    bool downAndOut = false;        // knock out at data.H on the time nodes, no rebate
+};
+
+struct MCResult
+{ // Statistics of the discounted payoff samples, the mean is the price
+    RunningStatistics call;
+    RunningStatistics put;
+    double callVRF;     // variance-reduction factor, 1 for plain MC, NaN when undefined
+    double putVRF;
+    long hitsOrigin;    // number of steps with S <= 0
+};
+
+class MonteCarloEngineBase
+{
+private:
+    struct BlockStats
+    { // Mergeable statistics of one block
+        RunningStatistics callPlain, putPlain;  // every simulated path
+        RunningStatistics call, put;            // estimator samples
+        RunningCovariance callCV, putCV;        // (payoff, control) pairs
+        long hitsOrigin = 0;
+
+        void merge(const BlockStats& s);
+    };
+
+    BlockStats simulateBlock(const std::vector<double>& x, const BrownianBridge* bridge, long count,
+                             unsigned long blockSeed, long firstPoint) const;
+    BlockStats simulateLockstep(const std::vector<double>& x, const BrownianBridge* bridge,
+                                const NormalGenerator& myNormal, long count, metrics::BlockTimers& timers) const;
+    void payoffs(const double* V, const double* alive, long n, double* call, double* put) const;
+    MCResult summarize(const BlockStats& total) const;
+
+protected:
+    OptionData data;    // S is the initial asset price
+    MCSettings settings;
+
+    // Terminal value of one path on mesh x driven by sign * dW, knockedOut is
+    // set when the path touches the barrier
+    virtual double simulatePath(const std::vector<double>& x, const double* dW, double sign,
+                                long& hitsOrigin, bool& knockedOut) const = 0;
+
+    // One step of length k from time t for n paths in lockstep, X[i] driven by
+    // sqrk * z[i]; returns the number of paths at or below the origin
+    virtual long advancePaths(double t, double k, double sqrk, double* X, const double* z, long n) const = 0;
+
+public:
+    static const long BlockSize = 1024;
+    static const long Replicates = 16;  // independent scrambles in QMC mode
+
+    // Throws std::invalid_argument for NSim < 2, NT < 1 or nThreads < 0
+    MonteCarloEngineBase(const OptionData& data, const MCSettings& settings);
+    virtual ~MonteCarloEngineBase() = default;
+
+    MCResult run() const;
+};
+
+template <class Model = GBM>
+class MonteCarloEngine : public MonteCarloEngineBase
+{
+private:
+    Model sde;
+
+    template <Scheme scheme>
+    double simulatePath(const std::vector<double>& x, const double* dW, double sign, long& hitsOrigin,
+                        bool& knockedOut) const
+    {
+        double k = data.T / double(x.size() - 1);
+        double sqrk = sign * std::sqrt(k);
+        double barrier = settings.downAndOut ? data.H : -std::numeric_limits<double>::infinity();
+        knockedOut = data.S <= barrier;
+
+        double VOld = data.S;
+        double VNew = VOld;
+        for (unsigned long index = 1; index < x.size(); ++index)
+        {
+            VNew = advance<scheme>(sde, x[index-1], VOld, k, sqrk, dW[index-1]);
+
+            VOld = VNew;
+
+            // Spurious values
+            if (VNew <= 0.0) hitsOrigin++;
+            if (VNew <= barrier) knockedOut = true;
+        }
+        return VNew;
+    }
+
+    double simulatePath(const std::vector<double>& x, const double* dW, double sign,
+                        long& hitsOrigin, bool& knockedOut) const override
+    { // Resolve the scheme once per path, the step itself is inlined
+        switch (settings.scheme)
+        {
+        case Scheme::Milstein: return simulatePath<Scheme::Milstein>(x, dW, sign, hitsOrigin, knockedOut);
+        case Scheme::LogEuler: return simulatePath<Scheme::LogEuler>(x, dW, sign, hitsOrigin, knockedOut);
+        case Scheme::ExactGBM: return simulatePath<Scheme::ExactGBM>(x, dW, sign, hitsOrigin, knockedOut);
+        default: return simulatePath<Scheme::Euler>(x, dW, sign, hitsOrigin, knockedOut);
+        }
+    }
+
+    template <Scheme scheme>
+    long advancePaths(double t, double k, double sqrk, double* __restrict X, const double* __restrict z,
+                      long n) const
+    { // Two branch-free loops: the local copy keeps the model constants in
+      // registers, and the count is separate since SSE2 cannot vectorize it inline
+        const Model model = sde;
+        for (long i = 0; i < n; ++i)
+            X[i] = advance<scheme>(model, t, X[i], k, sqrk, z[i]);
+
+        long hits = 0;
+        for (long i = 0; i < n; ++i)
+            hits += X[i] <= 0.0;
+        return hits;
+    }
+
+    long advancePaths(double t, double k, double sqrk, double* X, const double* z, long n) const override
+    {
+        switch (settings.scheme)
+        {
+        case Scheme::Milstein: return advancePaths<Scheme::Milstein>(t, k, sqrk, X, z, n);
+        case Scheme::LogEuler: return advancePaths<Scheme::LogEuler>(t, k, sqrk, X, z, n);
+        case Scheme::ExactGBM: return advancePaths<Scheme::ExactGBM>(t, k, sqrk, X, z, n);
+        default: return advancePaths<Scheme::Euler>(t, k, sqrk, X, z, n);
+        }
+    }
+
+public:
+    MonteCarloEngine(const OptionData& data, const Model& sde, const MCSettings& settings)
+        : MonteCarloEngineBase(data, settings), sde(sde)
+    {
+        if (settings.scheme == Scheme::ExactGBM && !sde.isGBM())
+            throw std::invalid_argument("MonteCarloEngine: exact stepping needs a GBM model");
+    }
+};
+
+#endif
@@ -15,12 +15,18 @@
 //  2009-5-16 DD generate fixed arrays of normal variates
 //	2009-6-29 DD Boost Normal generator
 //  2012-1-17 DD minimal Boost
+//  2026-10-18 HY seeded constructor for parallel streams
+//  2026-10-18 HY bulk fill(), ziggurat, Box-Muller and AS241 generators
+//  2026-10-18 HY Sobol in the factory
 //
 // (C) Datasim Education BV 2008-20012
 //
 
 #include "NormalGenerator.hpp"
+#include "SobolSequence.hpp"
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 
 
 
@@ -33,6 +39,15 @@ BoostNormal::BoostNormal() : NormalGenerator ()
 
 }
 
+BoostNormal::BoostNormal(boost::uint32_t seed) : NormalGenerator ()
+{
+	rng = boost::lagged_fibonacci607(seed);
+	nor = boost::normal_distribution<>(0,1);
+	myRandom = new boost::variate_generator<boost::lagged_fibonacci607&, boost::normal_distribution<> >
+			(rng, nor);
+
+}
+
 
 // Implement (variant) hook function
 double BoostNormal::getNormal() const
@@ -48,4 +63,319 @@ BoostNormal::~BoostNormal()
 }
 
 
+// Default bulk hook
+void NormalGenerator::fill(double* out, std::size_t n) const
+{
+	for (std::size_t i = 0; i < n; ++i)
+		out[i] = getNormal();
+}
+
+
+void BoostNormal::fill(double* out, std::size_t n) const
+{ // Same sequence as n calls of getNormal(), without the virtual call
+
+	for (std::size_t i = 0; i < n; ++i)
+		out[i] = (*myRandom)();
+}
+
+
+Xoshiro256::Xoshiro256(std::uint64_t seed)
+{
+	for (int i = 0; i < 4; ++i)
+	{ // splitmix64
+		std::uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		s[i] = z ^ (z >> 31);
+	}
+}
+
+
+// Ziggurat tables
+namespace
+{
+	const int ZigLayers = 128;
+	const double ZigR = 3.442619855899;			// start of the tail
+	const double ZigV = 9.91256303526217e-3;	// area of each layer
+
+	struct ZigguratTables
+	{
+		double x[ZigLayers + 1];	// layer edges, x[1] = R, x[128] = 0
+		double ratio[ZigLayers];	// x[i+1] / x[i], the quick acceptance test
+
+		ZigguratTables()
+		{
+			double f = exp(-0.5 * ZigR * ZigR);
+			x[0] = ZigV / f;
+			x[1] = ZigR;
+			x[ZigLayers] = 0.0;
+			for (int i = 2; i < ZigLayers; ++i)
+			{
+				x[i] = sqrt(-2.0 * log(ZigV / x[i - 1] + f));
+				f = exp(-0.5 * x[i] * x[i]);
+			}
+			for (int i = 0; i < ZigLayers; ++i)
+				ratio[i] = x[i + 1] / x[i];
+		}
+	};
 
+	const ZigguratTables& zigguratTables()
+	{
+		static const ZigguratTables tables;
+		return tables;
+	}
+}
+
+ZigguratNormal::ZigguratNormal(std::uint64_t seed) : NormalGenerator (), rng(seed)
+{
+	zigguratTables();
+}
+
+double ZigguratNormal::tail(bool negative) const
+{ // Marsaglia's tail method beyond R
+	double x, y;
+	do
+	{
+		x = log(rng.uniformOpen()) / ZigR;
+		y = log(rng.uniformOpen());
+	} while (-2.0 * y < x * x);
+	return negative ? x - ZigR : ZigR - x;
+}
+
+// Layer and abscissa of one draw. u in [-1, 1) comes from the top 52 bits as
+// the double 1 + k 2^-52 built from its bit pattern, which needs no integer to
+// double conversion, so the quick test below vectorizes
+static inline std::size_t zigLayer(std::uint64_t bits)
+{
+	return (bits >> 3) & (ZigLayers - 1);	// skip the weak low bits of xoshiro256+
+}
+
+static inline double zigAbscissa(std::uint64_t bits)
+{
+	std::uint64_t one = 0x3ff0000000000000ULL | (bits >> 12);	// the layer bits are not reused
+	double d;
+	std::memcpy(&d, &one, sizeof d);
+	return 2.0 * d - 3.0;
+}
+
+// Quick test of a block of draws: each value as if it lay in its layer's
+// rectangle, and a flag where it does not. Both table lookups are gathers,
+// which x86 has from AVX2 on, so that build of the loop is picked at run time
+static inline void zigQuick(const ZigguratTables& zig, const std::uint64_t* __restrict bits,
+	double* __restrict out, std::uint64_t* __restrict miss, std::size_t m)
+{
+	for (std::size_t j = 0; j < m; ++j)
+	{
+		std::size_t i = zigLayer(bits[j]);
+		double u = zigAbscissa(bits[j]);
+		out[j] = u * zig.x[i];
+		miss[j] = fabs(u) >= zig.ratio[i];
+	}
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2")))
+static void zigQuickAvx2(const ZigguratTables& zig, const std::uint64_t* __restrict bits,
+	double* __restrict out, std::uint64_t* __restrict miss, std::size_t m)
+{
+	zigQuick(zig, bits, out, miss, m);
+}
+#endif
+
+static void zigQuickBlock(const ZigguratTables& zig, const std::uint64_t* bits, double* out,
+	std::uint64_t* miss, std::size_t m)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	static const bool avx2 = __builtin_cpu_supports("avx2");
+	if (avx2)
+		return zigQuickAvx2(zig, bits, out, miss, m);
+#endif
+	zigQuick(zig, bits, out, miss, m);
+}
+
+double ZigguratNormal::wedge(int i, double u) const
+{ // The draw missed the rectangle of layer i: the tail, the wedge or a new draw
+	const ZigguratTables& zig = zigguratTables();
+	if (i == 0)
+		return tail(u < 0.0);
+
+	double x = u * zig.x[i];
+	double f0 = exp(-0.5 * (zig.x[i] * zig.x[i] - x * x));
+	double f1 = exp(-0.5 * (zig.x[i + 1] * zig.x[i + 1] - x * x));
+	if (f1 + rng.uniform() * (f0 - f1) < 1.0)
+		return x;
+	return getNormal();
+}
+
+double ZigguratNormal::getNormal() const
+{
+	const ZigguratTables& zig = zigguratTables();
+	std::uint64_t bits = rng.next();
+	std::size_t i = zigLayer(bits);
+	double u = zigAbscissa(bits);
+
+	if (fabs(u) < zig.ratio[i])
+		return u * zig.x[i];
+	return wedge(int(i), u);
+}
+
+void ZigguratNormal::fill(double* out, std::size_t n) const
+{ // Per block: the draws, the vectorized quick test, then the misses (about
+  // 1.2%) through the wedge and the tail, which draw after the block
+	const ZigguratTables& zig = zigguratTables();
+	const std::size_t Block = 256;
+	std::uint64_t bits[Block], miss[Block];
+	for (std::size_t start = 0; start < n; start += Block)
+	{
+		std::size_t m = std::min(Block, n - start);
+		double* block = out + start;
+		for (std::size_t j = 0; j < m; ++j)
+			bits[j] = rng.next();
+
+		zigQuickBlock(zig, bits, block, miss, m);
+
+		for (std::size_t j = 0; j < m; ++j)
+			if (miss[j])
+				block[j] = wedge(int(zigLayer(bits[j])), zigAbscissa(bits[j]));
+	}
+}
+
+
+BoxMullerNormal::BoxMullerNormal(std::uint64_t seed) : NormalGenerator (), rng(seed), spare(0.0), hasSpare(false) {}
+
+double BoxMullerNormal::getNormal() const
+{
+	double z;
+	fill(&z, 1);
+	return z;
+}
+
+void BoxMullerNormal::fill(double* out, std::size_t n) const
+{
+	std::size_t i = 0;
+	if (hasSpare && n > 0)
+	{
+		out[i++] = spare;
+		hasSpare = false;
+	}
+
+	const std::size_t Block = 512;	// 4 KB of output per pass
+	const double TwoPi = 6.283185307179586476925;
+	while (i + 1 < n)
+	{
+		std::size_t m = std::min(Block, (n - i) & ~std::size_t(1));
+		double* z = out + i;
+		for (std::size_t j = 0; j < m; j += 2)
+		{
+			z[j] = rng.uniformOpen();
+			z[j + 1] = rng.uniform();
+		}
+		for (std::size_t j = 0; j < m; j += 2)
+		{ // Transform in place
+			double r = sqrt(-2.0 * log(z[j]));
+			double theta = TwoPi * z[j + 1];
+			z[j] = r * cos(theta);
+			z[j + 1] = r * sin(theta);
+		}
+		i += m;
+	}
+
+	if (i < n)
+	{ // Odd count, keep the second variate of the pair
+		double r = sqrt(-2.0 * log(rng.uniformOpen()));
+		double theta = TwoPi * rng.uniform();
+		out[i] = r * cos(theta);
+		spare = r * sin(theta);
+		hasSpare = true;
+	}
+}
+
+
+// AS241 central region, |q| <= 0.425
+static inline double ppndCentral(double q)
+{
+	double r = 0.180625 - q * q;
+	return q * (((((((r * 2509.0809287301226727 + 33430.575583588128105) * r + 67265.770927008700853) * r
+				+ 45921.953931549871457) * r + 13731.693765509461125) * r + 1971.5909503065514427) * r
+				+ 133.14166789178437745) * r + 3.387132872796366608)
+		/ (((((((r * 5226.495278852545561 + 28729.085735721942674) * r + 39307.89580009271061) * r
+				+ 21213.794301586595867) * r + 5394.1960214247511077) * r + 687.1870074920579083) * r
+				+ 42.313330701600911252) * r + 1.0);
+}
+
+// AS241 tails, r = min(p, 1 - p)
+static double ppndTail(double q, double r)
+{
+	r = sqrt(-log(r));
+	double x;
+	if (r <= 5.0)
+	{
+		r -= 1.6;
+		x = (((((((r * 7.7454501427834140764e-4 + 0.0227238449892691845833) * r + 0.24178072517745061177) * r
+				+ 1.27045825245236838258) * r + 3.64784832476320460504) * r + 5.7694972214606914055) * r
+				+ 4.6303378461565452959) * r + 1.42343711074968357734)
+			/ (((((((r * 1.05075007164441684324e-9 + 5.475938084995344946e-4) * r + 0.0151986665636164571966) * r
+				+ 0.14810397642748007459) * r + 0.68976733498510000455) * r + 1.6763848301838038494) * r
+				+ 2.05319162663775882187) * r + 1.0);
+	}
+	else
+	{
+		r -= 5.0;
+		x = (((((((r * 2.01033439929228813265e-7 + 2.71155556874348757815e-5) * r + 0.0012426609473880784386) * r
+				+ 0.026532189526576123093) * r + 0.29656057182850489123) * r + 1.7848265399172913358) * r
+				+ 5.4637849111641143699) * r + 6.6579046435011037772)
+			/ (((((((r * 2.04426310338993978564e-15 + 1.4215117583164458887e-7) * r + 1.8463183175100546818e-5) * r
+				+ 7.868691311456132591e-4) * r + 0.0148753612908506148525) * r + 0.13692988092273580531) * r
+				+ 0.59983220655588793769) * r + 1.0);
+	}
+	return q < 0.0 ? -x : x;
+}
+
+double InverseNormal::inverseCdf(double p)
+{
+	double q = p - 0.5;
+	if (fabs(q) <= 0.425)
+		return ppndCentral(q);
+	return ppndTail(q, q < 0.0 ? p : 1.0 - p);
+}
+
+InverseNormal::InverseNormal(std::uint64_t seed) : NormalGenerator (), rng(seed) {}
+
+double InverseNormal::getNormal() const
+{
+	return inverseCdf(rng.uniformCentred());
+}
+
+void InverseNormal::fill(double* out, std::size_t n) const
+{
+	const std::size_t Block = 512;
+	double p[Block];
+	for (std::size_t i = 0; i < n; i += Block)
+	{
+		std::size_t m = std::min(Block, n - i);
+		double* z = out + i;
+		for (std::size_t j = 0; j < m; ++j)
+			p[j] = rng.uniformCentred();
+		for (std::size_t j = 0; j < m; ++j)	// clamped, the tail lanes are redone below
+			z[j] = ppndCentral(std::min(std::max(p[j] - 0.5, -0.425), 0.425));
+		for (std::size_t j = 0; j < m; ++j)
+		{
+			double q = p[j] - 0.5;
+			if (fabs(q) > 0.425)
+				z[j] = ppndTail(q, q < 0.0 ? p[j] : 1.0 - p[j]);
+		}
+	}
+}
+
+
+std::unique_ptr<NormalGenerator> createNormalGenerator(NormalMethod method, std::uint64_t seed, std::size_t dimension)
+{
+	switch (method)
+	{
+	case NormalMethod::Sobol: return std::make_unique<SobolNormal>(dimension, seed);
+	case NormalMethod::Ziggurat: return std::make_unique<ZigguratNormal>(seed);
+	case NormalMethod::BoxMuller: return std::make_unique<BoxMullerNormal>(seed);
+	case NormalMethod::InverseCdf: return std::make_unique<InverseNormal>(seed);
+	default: return std::make_unique<BoostNormal>((boost::uint32_t)seed);
+	}
+}
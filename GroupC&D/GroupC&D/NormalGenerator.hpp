@@ -11,6 +11,7 @@
 // functions. In another chapter we use policy classes and templates.
 //
 // 2012-17 DD restrict to Boost
+// 2026-10-18 HY bulk fill() hook, ziggurat, Box-Muller and AS241 generators
 //
 // (C) Datasim Education BV 2008-2012
 //
@@ -23,14 +24,22 @@
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/random/normal_distribution.hpp>
 #include <boost/random/variate_generator.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 
 class NormalGenerator
 {
 
 public:
 
-	// Empty at the moment
 	virtual double getNormal() const = 0;
+
+	// Bulk hook: n variates into out. The default loops over getNormal(),
+	// derived classes generate whole blocks without a call per variate.
+	virtual void fill(double* out, std::size_t n) const;
+
+	virtual ~NormalGenerator() {}
 };
 
 
@@ -42,16 +51,116 @@ private:
 	boost::normal_distribution<> nor;
 //
 	boost::variate_generator<boost::lagged_fibonacci607&, boost::normal_distribution<> >* myRandom;
+	BoostNormal(const BoostNormal&) = delete;	// myRandom refers to rng
+	BoostNormal& operator = (const BoostNormal&) = delete;
 
 
 public:
 	BoostNormal();	// NB no uniform parameters
+	BoostNormal(boost::uint32_t seed);	// Independent stream per seed
 
 	// Implement (variant) hook function
 	double getNormal() const;
+	void fill(double* out, std::size_t n) const;
 
 	virtual ~BoostNormal();
 };
 
 
+// Uniform strategy for the generators below: xoshiro256+ (Blackman, Vigna),
+// 2^256 - 1 period, seeded through splitmix64
+class Xoshiro256
+{
+private:
+
+	std::uint64_t s[4];
+
+public:
+	explicit Xoshiro256(std::uint64_t seed = 0);
+
+	std::uint64_t next()
+	{
+		std::uint64_t result = s[0] + s[3];
+		std::uint64_t t = s[1] << 17;
+		s[2] ^= s[0]; s[3] ^= s[1]; s[1] ^= s[2]; s[0] ^= s[3];
+		s[2] ^= t;
+		s[3] = (s[3] << 45) | (s[3] >> 19);
+		return result;
+	}
+
+	double uniform() { return (next() >> 11) * 0x1.0p-53; }			// [0, 1)
+	double uniformOpen() { return ((next() >> 11) + 1) * 0x1.0p-53; }	// (0, 1]
+	// (0, 1), the centres of 2^52 bins: k + 0.5 is exact for k < 2^52, so it never rounds to 1
+	double uniformCentred() { return ((next() >> 12) + 0.5) * 0x1.0p-52; }
+};
+
+
+// Marsaglia-Tsang ziggurat, 128 layers (Doornik's ZIGNOR variant). One 64-bit
+// draw gives the layer and the abscissa; about 98.8% of variates cost one
+// multiply and one compare. fill() runs that quick test over blocks of draws as
+// a vectorized loop and takes the misses afterwards, so its sequence differs
+// from repeated getNormal() calls but has the same distribution.
+class ZigguratNormal : public NormalGenerator
+{
+private:
+
+	mutable Xoshiro256 rng;
+
+	double tail(bool negative) const;
+	double wedge(int layer, double u) const;	// a draw outside the layer's rectangle
+
+public:
+	ZigguratNormal(std::uint64_t seed = 0);
+
+	double getNormal() const;
+	void fill(double* out, std::size_t n) const;
+};
+
+
+// Box-Muller in blocks: uniforms are drawn into the output first and then
+// transformed in place two at a time, so the transform loop has no calls
+// into the generator and vectorizes
+class BoxMullerNormal : public NormalGenerator
+{
+private:
+
+	mutable Xoshiro256 rng;
+	mutable double spare;
+	mutable bool hasSpare;
+
+public:
+	BoxMullerNormal(std::uint64_t seed = 0);
+
+	double getNormal() const;
+	void fill(double* out, std::size_t n) const;
+};
+
+
+// Inverse cumulative normal, Wichura's AS241 (PPND16, relative accuracy 1e-16).
+// The central region |p - 0.5| <= 0.425 is a branch-free rational function
+// applied to the whole block; the tails (about 15% of draws) are fixed up
+// in a second pass. Monotone in the uniform, so it suits stratification and QMC.
+class InverseNormal : public NormalGenerator
+{
+private:
+
+	mutable Xoshiro256 rng;
+
+public:
+	InverseNormal(std::uint64_t seed = 0);
+
+	static double inverseCdf(double p);	// p in (0, 1)
+
+	double getNormal() const;
+	void fill(double* out, std::size_t n) const;
+};
+
+
+enum class NormalMethod { Boost, Ziggurat, BoxMuller, InverseCdf, Sobol };
+
+// Factory, each seed gives an independent stream. Sobol (SobolSequence.hpp)
+// returns scrambled points of the given dimension, one point per fill(out, dimension).
+std::unique_ptr<NormalGenerator> createNormalGenerator(NormalMethod method, std::uint64_t seed, std::size_t dimension = 1);
+
+
 #endif
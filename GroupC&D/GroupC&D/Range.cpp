@@ -16,6 +16,7 @@
 // AM 25-03-1996 Changed subset, intersects modified to use contains
 // 2001-1-30 DD length() function
 // 20023-1-21 DD Lite version for book
+// 2026-10-18 HY mesh() into an existing vector, nodes without accumulated drift
 //
 // (C) Datasim Education BV 1994-2006
 
@@ -152,19 +153,26 @@ template <class Type>
 std::vector<Type> Range<Type>::mesh(long nSteps) const
 { // Create a discrete mesh
 
-	Type h = (hi - lo) / Type (nSteps);
+	std::vector<Type> result;
+	mesh(nSteps, result);
 
-	std::vector<Type>result(nSteps + 1);
+	return result;
+}
 
-	Type val = lo;
+template <class Type>
+void Range<Type>::mesh(long nSteps, std::vector<Type>& result) const
+{ // Create a discrete mesh in result, reusing its storage
 
-	for (long i = 0; i < nSteps + 1; i++)	
+	Type h = (hi - lo) / Type (nSteps);
+
+	result.resize(nSteps + 1);
+
+	// Each node from its index, repeated val += h would drift
+	for (long i = 0; i < nSteps; i++)	
 	{
-		result[i] = val;
-		val += h;
+		result[i] = lo + Type (i) * h;
 	}
-
-	return result;
+	result[nSteps] = hi;
 }
 
 
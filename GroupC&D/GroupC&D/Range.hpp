@@ -45,6 +45,7 @@ public:
 	
 	// Utility functions
 	std::vector<Type> mesh(long nSteps) const;	// Create a discrete mesh
+	void mesh(long nSteps, std::vector<Type>& result) const;	// Mesh into an existing vector, keeps its capacity
 
 	// Operator overloading
 	Range<Type>& operator = (const Range<Type>& ran2);
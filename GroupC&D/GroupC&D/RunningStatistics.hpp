@@ -0,0 +1,119 @@
+// RunningStatistics.hpp
+//
+// Streaming mean and variance (Welford) in O(1) memory. Two accumulators
+// merge exactly (Chan, Golub and LeVeque), so each thread or block keeps its
+// own and the results are combined at the end without storing any samples.
+// RunningCovariance does the same for a pair (Y, X) and applies a control
+// variate X with known mean.
+//
+// Hanlin Yan
+// Oct 18 2026
+//
+
+#ifndef RunningStatistics_HPP
+#define RunningStatistics_HPP
+
+#include "NormalGenerator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+class RunningStatistics
+{
+private:
+    long n;
+    double avg;     // running mean
+    double m2;      // sum of squared deviations from the mean
+
+public:
+    RunningStatistics() : n(0), avg(0.0), m2(0.0) {}
+    RunningStatistics(long n, double mean, double m2) : n(n), avg(mean), m2(m2) {}
+
+    void add(double x)
+    {
+        n++;
+        double delta = x - avg;
+        avg += delta / double(n);
+        m2 += delta * (x - avg);
+    }
+
+    void merge(const RunningStatistics& o)
+    {
+        if (o.n == 0) return;
+        if (n == 0) { *this = o; return; }
+
+        double total = double(n + o.n);
+        double delta = o.avg - avg;
+        avg += delta * double(o.n) / total;
+        m2 += o.m2 + delta * delta * double(n) * double(o.n) / total;
+        n += o.n;
+    }
+
+    long count() const { return n; }
+    double mean() const { return avg; }
+    double variance() const { return n > 1 ? m2 / double(n - 1) : 0.0; }    // sample variance
+    double SD() const { return std::sqrt(variance()); }
+    double SE() const { return n > 0 ? SD() / std::sqrt(double(n)) : 0.0; }
+
+    // Two-sided normal confidence interval for the mean
+    std::pair<double, double> confidenceInterval(double level = 0.95) const
+    {
+        double z = InverseNormal::inverseCdf(0.5 + 0.5 * level);
+        return std::make_pair(avg - z * SE(), avg + z * SE());
+    }
+};
+
+
+class RunningCovariance
+{ // Streaming moments of a pair (Y, X), used for control variates
+private:
+    long n;
+    double avgX, avgY;
+    double m2X, m2Y, cXY;   // sums of squared and cross deviations
+
+public:
+    RunningCovariance() : n(0), avgX(0.0), avgY(0.0), m2X(0.0), m2Y(0.0), cXY(0.0) {}
+    RunningCovariance(long n, double meanY, double meanX, double m2Y, double m2X, double cXY)
+        : n(n), avgX(meanX), avgY(meanY), m2X(m2X), m2Y(m2Y), cXY(cXY) {}
+
+    void add(double y, double x)
+    {
+        n++;
+        double dX = x - avgX;
+        double dY = y - avgY;
+        avgX += dX / double(n);
+        avgY += dY / double(n);
+        m2X += dX * (x - avgX);
+        m2Y += dY * (y - avgY);
+        cXY += dX * (y - avgY);
+    }
+
+    void merge(const RunningCovariance& o)
+    {
+        if (o.n == 0) return;
+        if (n == 0) { *this = o; return; }
+
+        double total = double(n + o.n);
+        double w = double(n) * double(o.n) / total;
+        double dX = o.avgX - avgX;
+        double dY = o.avgY - avgY;
+        avgX += dX * double(o.n) / total;
+        avgY += dY * double(o.n) / total;
+        m2X += o.m2X + dX * dX * w;
+        m2Y += o.m2Y + dY * dY * w;
+        cXY += o.cXY + dX * dY * w;
+        n += o.n;
+    }
+
+    long count() const { return n; }
+
+    // Statistics of Y - c (X - EX) with the variance-minimising c = cov(X, Y) / var(X)
+    RunningStatistics controlled(double EX) const
+    {
+        if (m2X <= 0.0) return RunningStatistics(n, avgY, m2Y);
+        double c = cXY / m2X;
+        return RunningStatistics(n, avgY - c * (avgX - EX), std::max(m2Y - c * cXY, 0.0));
+    }
+};
+
+#endif
@@ -0,0 +1,148 @@
+// SDE.hpp
+//
+// One-factor SDE models dX = a(t, X) dt + b(t, X) dW as policy classes.
+// A model supplies drift(), diffusion(), diffusionDerivative() and isGBM();
+// the engine is templated on the model, so these inline into the path loop
+// and the compiler can hoist the constants. Every engine owns a copy of its
+// model, so several options can be priced concurrently in one process.
+//
+//  GBM            dS = r S dt + sig S dW
+//  CEV<Beta>      dS = r S dt + sig S^beta dW; Beta is double for a runtime
+//                 elasticity or FixedBeta<num, den> for a compile-time one,
+//                 where beta = 1, 1/2 and 0 need no pow
+//  MeanReverting  dS = kappa (theta - S) dt + sig S dW
+//
+// Time stepping schemes, z ~ N(0, 1), k the step and a, b drift and diffusion:
+//  Euler     X + a k + b sqrt(k) z
+//  Milstein  Euler + 0.5 b b' k (z^2 - 1), strong order 1
+//  LogEuler  Euler on log X, X exp((a/X - 0.5 (b/X)^2) k + (b/X) sqrt(k) z);
+//            stays positive and is exact for GBM on any grid
+//  ExactGBM  one step to expiry, S exp((r - 0.5 sig^2) T + sig sqrt(T) z);
+//            needs a GBM model and a payoff that only uses S(T)
+//
+// Hanlin Yan
+// Oct 18 2026
+//
+
+#ifndef SDE_HPP
+#define SDE_HPP
+
+#include "OptionData.hpp"
+#include <cmath>
+#include <type_traits>
+
+enum class Scheme { Euler, Milstein, LogEuler, ExactGBM };
+
+class GBM
+{
+private:
+    double r;           // interest rate
+    double sig;         // volatility
+
+public:
+    GBM(const OptionData& data) : r(data.r), sig(data.sig) {}
+
+    static constexpr bool isGBM() { return true; }
+
+    double drift(double, double X) const { return r * X; }
+    double diffusion(double, double X) const { return sig * X; }
+    double diffusionDerivative(double, double) const { return sig; }
+};
+
+template <int num, int den = 1>
+struct FixedBeta
+{ // Elasticity known at compile time, num / den
+    static constexpr double value = double(num) / double(den);
+};
+
+template <class Beta = double>
+class CEV
+{
+private:
+    static constexpr bool fixed = !std::is_same_v<Beta, double>;
+
+    double r;           // interest rate
+    double sig;         // volatility
+    double betaCEV;     // elasticity factor, only read when it is not fixed
+
+public:
+    CEV(const OptionData& data, double betaCEV) : r(data.r), sig(data.sig), betaCEV(betaCEV)
+    {
+        static_assert(!fixed, "a fixed elasticity is given by the template argument");
+    }
+
+    CEV(const OptionData& data) : r(data.r), sig(data.sig), betaCEV(0.0)
+    {
+        static_assert(fixed, "a runtime elasticity needs a value");
+    }
+
+    double beta() const
+    {
+        if constexpr (fixed) return Beta::value;
+        else return betaCEV;
+    }
+
+    constexpr bool isGBM() const
+    {
+        if constexpr (fixed) return Beta::value == 1.0;
+        else return betaCEV == 1.0;
+    }
+
+    double drift(double, double X) const { return r * X; }
+
+    double diffusion(double, [[maybe_unused]] double X) const
+    {
+        if constexpr (!fixed) return sig * std::pow(X, betaCEV);
+        else if constexpr (Beta::value == 1.0) return sig * X;
+        else if constexpr (Beta::value == 0.5) return sig * std::sqrt(X);
+        else if constexpr (Beta::value == 0.0) return sig;
+        else return sig * std::pow(X, Beta::value);
+    }
+
+    double diffusionDerivative(double, [[maybe_unused]] double X) const
+    {
+        if constexpr (!fixed) return sig * betaCEV * std::pow(X, betaCEV - 1.0);
+        else if constexpr (Beta::value == 1.0) return sig;
+        else if constexpr (Beta::value == 0.5) return 0.5 * sig / std::sqrt(X);
+        else if constexpr (Beta::value == 0.0) return 0.0;
+        else return sig * Beta::value * std::pow(X, Beta::value - 1.0);
+    }
+};
+
+class MeanReverting
+{
+private:
+    double kappa;       // speed of mean reversion
+    double theta;       // long-run level
+    double sig;         // volatility
+
+public:
+    MeanReverting(const OptionData& data, double kappa, double theta)
+        : kappa(kappa), theta(theta), sig(data.sig) {}
+
+    static constexpr bool isGBM() { return false; }
+
+    double drift(double, double X) const { return kappa * (theta - X); }
+    double diffusion(double, double X) const { return sig * X; }
+    double diffusionDerivative(double, double) const { return sig; }
+};
+
+// One step of length k from (t, X) with standard normal z, sqrk = sqrt(k)
+template <Scheme scheme, class Model>
+inline double advance(const Model& sde, double t, double X, double k, double sqrk, double z)
+{
+    if constexpr (scheme == Scheme::Euler)
+        return X + k * sde.drift(t, X) + sqrk * sde.diffusion(t, X) * z;
+    else if constexpr (scheme == Scheme::Milstein)
+    {
+        double b = sde.diffusion(t, X);
+        return X + k * sde.drift(t, X) + sqrk * b * z + 0.5 * b * sde.diffusionDerivative(t, X) * k * (z * z - 1.0);
+    }
+    else
+    { // LogEuler, and ExactGBM whose single step is the same formula for GBM
+        double a = sde.drift(t, X) / X, b = sde.diffusion(t, X) / X;
+        return X * std::exp((a - 0.5 * b * b) * k + b * sqrk * z);
+    }
+}
+
+#endif
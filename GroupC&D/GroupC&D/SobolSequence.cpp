@@ -0,0 +1,137 @@
+// SobolSequence.cpp
+//
+// Sobol sequence, direction numbers and scrambling.
+//
+// Hanlin Yan
+// Oct 18 2026
+//
+
+#include "SobolSequence.hpp"
+#include "SobolDirectionTable.hpp"
+#include <stdexcept>
+
+namespace
+{
+    struct DirectionNumbers
+    {
+        std::vector<std::uint32_t> v;   // 32 per dimension, most significant bit first
+
+        DirectionNumbers() : v(32 * SobolSequence::MaxDimension)
+        {
+            static_assert(sobol_table::Rows + 1 >= SobolSequence::MaxDimension, "Sobol table too short");
+            for (int k = 0; k < 32; ++k)
+                v[k] = 1u << (31 - k);
+
+            for (std::size_t d = 1; d < SobolSequence::MaxDimension; ++d)
+            {
+                std::uint32_t p = sobol_table::polynomial[d - 1];
+                int s = 31 - __builtin_clz(p);                          // degree
+                std::uint32_t a = (p >> 1) & ((1u << (s - 1)) - 1);     // inner coefficients
+
+                std::uint32_t* w = &v[32 * d];
+                for (int k = 0; k < s; ++k)
+                    w[k] = std::uint32_t(sobol_table::initial[d - 1][k]) << (31 - k);
+                for (int k = s; k < 32; ++k)
+                { // Recurrence of the polynomial
+                    w[k] = w[k - s] ^ (w[k - s] >> s);
+                    for (int i = 1; i < s; ++i)
+                        if ((a >> (s - 1 - i)) & 1) w[k] ^= w[k - i];
+                }
+            }
+        }
+    };
+
+    const DirectionNumbers& directionNumbers()
+    {
+        static const DirectionNumbers table;
+        return table;
+    }
+
+    int lowestSetBit(std::uint32_t n)
+    {
+        int c = 0;
+        while (!(n & 1)) { n >>= 1; ++c; }
+        return c;
+    }
+}
+
+SobolSequence::SobolSequence(std::size_t dimension, std::uint32_t firstIndex)
+    : dim(dimension), shift(dimension, 0), x(dimension), index(0)
+{
+    if (dimension == 0 || dimension > MaxDimension)
+        throw std::out_of_range("SobolSequence: dimension must be in [1, 1111]");
+    const std::vector<std::uint32_t>& table = directionNumbers().v;
+    v.assign(table.begin(), table.begin() + 32 * dim);
+    skipTo(firstIndex);
+}
+
+void SobolSequence::scramble(std::uint64_t seed)
+{
+    Xoshiro256 rng(seed);
+    for (std::size_t j = 0; j < dim; ++j)
+    {
+        std::uint32_t row[32];  // row i: output digit i depends on input digits 0..i
+        for (int i = 0; i < 32; ++i)
+        {
+            std::uint32_t above = i == 0 ? 0 : ~0u << (32 - i);
+            row[i] = (std::uint32_t(rng.next() >> 32) & above) | (1u << (31 - i));
+        }
+        for (int k = 0; k < 32; ++k)
+        {
+            std::uint32_t in = v[32 * j + k], out = 0;
+            for (int i = 0; i < 32; ++i)
+                out |= std::uint32_t(__builtin_parity(in & row[i])) << (31 - i);
+            v[32 * j + k] = out;
+        }
+        shift[j] = std::uint32_t(rng.next() >> 32);
+    }
+    skipTo(index);
+}
+
+void SobolSequence::skipTo(std::uint32_t n)
+{
+    index = n;
+    std::uint32_t gray = n ^ (n >> 1);
+    for (std::size_t j = 0; j < dim; ++j)
+    {
+        std::uint32_t xj = shift[j];
+        for (int k = 0; k < 32; ++k)
+            if ((gray >> k) & 1) xj ^= v[32 * j + k];
+        x[j] = xj;
+    }
+}
+
+void SobolSequence::next(double* u)
+{
+    for (std::size_t j = 0; j < dim; ++j)
+        u[j] = (double(x[j]) + 0.5) * 0x1.0p-32;
+
+    int c = lowestSetBit(++index);  // Gray code: flip one direction number
+    for (std::size_t j = 0; j < dim; ++j)
+        x[j] ^= v[32 * j + c];
+}
+
+
+SobolNormal::SobolNormal(std::size_t dimension, std::uint64_t seed, std::uint32_t firstIndex)
+    : NormalGenerator (), sobol(dimension, firstIndex), point(dimension), cursor(dimension)
+{
+    sobol.scramble(seed);
+}
+
+double SobolNormal::getNormal() const
+{
+    if (cursor == point.size())
+    {
+        sobol.next(point.data());
+        for (double& u : point)
+            u = InverseNormal::inverseCdf(u);
+        cursor = 0;
+    }
+    return point[cursor++];
+}
+
+void SobolNormal::fill(double* out, std::size_t n) const
+{
+    for (std::size_t i = 0; i < n; ++i)
+        out[i] = SobolNormal::getNormal();
+}
@@ -0,0 +1,87 @@
+// TridiagonalSolver.cpp
+//
+// Thomas algorithm with a stored factorisation, and the Brennan-Schwartz
+// projected variant.
+//
+// Hanlin Yan
+// Oct 18 2026
+//
+
+#include "TridiagonalSolver.hpp"
+#include <algorithm>
+
+void TridiagonalSolver::factor(const double* a, const double* b, const double* c, long n, bool reverse)
+{
+    this->n = n;
+    this->reverse = reverse;
+    coupling.resize(n);
+    ratio.resize(n);
+    pivot.resize(n);
+
+    if (!reverse)
+    { // Eliminate a_i going down, back substitution goes up
+        pivot[0] = 1.0 / b[0];
+        ratio[0] = n > 1 ? c[0] * pivot[0] : 0.0;
+        coupling[0] = 0.0;
+        for (long i = 1; i < n; ++i)
+        {
+            pivot[i] = 1.0 / (b[i] - a[i] * ratio[i-1]);
+            ratio[i] = i < n - 1 ? c[i] * pivot[i] : 0.0;
+            coupling[i] = a[i];
+        }
+    }
+    else
+    { // Eliminate c_i going up, back substitution goes down
+        pivot[n-1] = 1.0 / b[n-1];
+        ratio[n-1] = n > 1 ? a[n-1] * pivot[n-1] : 0.0;
+        coupling[n-1] = 0.0;
+        for (long i = n - 2; i >= 0; --i)
+        {
+            pivot[i] = 1.0 / (b[i] - c[i] * ratio[i+1]);
+            ratio[i] = i > 0 ? a[i] * pivot[i] : 0.0;
+            coupling[i] = c[i];
+        }
+    }
+}
+
+void TridiagonalSolver::solve(const double* d, double* x) const
+{
+    if (!reverse)
+    {
+        x[0] = d[0] * pivot[0];
+        for (long i = 1; i < n; ++i)
+            x[i] = (d[i] - coupling[i] * x[i-1]) * pivot[i];
+        for (long i = n - 2; i >= 0; --i)
+            x[i] -= ratio[i] * x[i+1];
+    }
+    else
+    {
+        x[n-1] = d[n-1] * pivot[n-1];
+        for (long i = n - 2; i >= 0; --i)
+            x[i] = (d[i] - coupling[i] * x[i+1]) * pivot[i];
+        for (long i = 1; i < n; ++i)
+            x[i] -= ratio[i] * x[i-1];
+    }
+}
+
+void TridiagonalSolver::solveProjected(const double* d, const double* g, double* x) const
+{ // As solve(), with the constraint applied as each value is completed
+    if (!reverse)
+    {
+        x[0] = d[0] * pivot[0];
+        for (long i = 1; i < n; ++i)
+            x[i] = (d[i] - coupling[i] * x[i-1]) * pivot[i];
+        x[n-1] = std::max(x[n-1], g[n-1]);
+        for (long i = n - 2; i >= 0; --i)
+            x[i] = std::max(x[i] - ratio[i] * x[i+1], g[i]);
+    }
+    else
+    {
+        x[n-1] = d[n-1] * pivot[n-1];
+        for (long i = n - 2; i >= 0; --i)
+            x[i] = (d[i] - coupling[i] * x[i+1]) * pivot[i];
+        x[0] = std::max(x[0], g[0]);
+        for (long i = 1; i < n; ++i)
+            x[i] = std::max(x[i] - ratio[i] * x[i-1], g[i]);
+    }
+}
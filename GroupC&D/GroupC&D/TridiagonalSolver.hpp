@@ -0,0 +1,48 @@
+// TridiagonalSolver.hpp
+//
+// Thomas algorithm for a tridiagonal system a_i x_{i-1} + b_i x_i + c_i x_{i+1} = d_i
+// in O(n). The elimination depends on the matrix only, so it is done once in
+// factor() and every right-hand side then costs one forward and one backward
+// sweep. Storage is kept between factorisations, so a solver reused for
+// matrices of the same size does not allocate.
+//
+// solveProjected() is the Brennan-Schwartz algorithm for the linear
+// complementarity problem of an American option, x >= g. The back
+// substitution applies the constraint, so it must start inside the exercise
+// region: top down (the default) for a call, whose exercise region is at high
+// indices, and bottom up (reverse) for a put.
+//
+// Hanlin Yan
+// Oct 18 2026
+//
+
+#ifndef TridiagonalSolver_HPP
+#define TridiagonalSolver_HPP
+
+#include <vector>
+
+class TridiagonalSolver
+{
+private:
+    std::vector<double> coupling;   // a_i or c_i, whichever the sweep eliminates last
+    std::vector<double> ratio;      // normalised c'_i (or a'_i when reversed)
+    std::vector<double> pivot;      // inverse pivots 1 / b'_i
+    bool reverse;
+    long n;
+
+public:
+    TridiagonalSolver() : reverse(false), n(0) {}
+
+    // a[0] and c[n-1] are not used. reverse eliminates from the last row up.
+    void factor(const double* a, const double* b, const double* c, long n, bool reverse = false);
+
+    long size() const { return n; }
+
+    // d and x may be the same array
+    void solve(const double* d, double* x) const;
+
+    // Solution of the complementarity problem with x >= g
+    void solveProjected(const double* d, const double* g, double* x) const;
+};
+
+#endif
@@ -10,14 +10,21 @@
 // Adding SDSE function
 // Hanlin Yan
 // Oct 25 2025
+//
+// The path loop lives in MonteCarloEngine, run with
+// NT NSim [seed] [threads] [generator] on the command line or interactively.
 // (C) Datasim Education BC 2008-2011
 //
 
 #include "OptionData.hpp"
-#include "NormalGenerator.hpp"
-#include "Range.cpp"
+#include "MonteCarloEngine.hpp"
+#include "FDMEngine.hpp"
+#include "ExactSolution.hpp"
+#include "SDE.hpp"
+#include "Metrics.hpp"
 #include <cmath>
 #include <iostream>
+#include <sstream>
 #include <boost/tuple/tuple.hpp>
 #include <boost/tuple/tuple_io.hpp>
 
@@ -37,56 +44,39 @@ template <class T> void print(const std::vector<T>& myList)
     std::cout << "]\n";
 }
 
-//helper function to compute SD and SE
-template <typename Type>
-boost::tuple<Type, Type> SDSE(const std::vector<Type>& price, const Type& r, const Type& T)
-{
-    Type temp1(0), temp2(0);
-    for (int i = 0; i < price.size(); i++)
-    {
-        temp1 += price[i] * price[i];
-        temp2 += price[i];
-    }
-
-    int M = price.size();
-    Type sd = sqrt((temp1 - 1 / M * temp2 * temp2) / (M - 1)) * exp(- r * T);
-    Type se = sd / sqrt(M);
-
-    return boost::make_tuple(sd, se);
+static std::string formatVRF(double vrf)
+{ // NaN when the estimator variance is 0
+    if (std::isnan(vrf))
+        return "undefined";
+    std::ostringstream out;
+    out << vrf;
+    return out.str();
 }
 
-namespace SDEDefinition
-{ // Defines drift + diffusion + data
-
-    OptionData* data;                // The data for the option MC
-
-    double drift(double t, double X)
-    { // Drift term
-    
-        return (data->r)*X; // r - D
-    }
-
-    
-    double diffusion(double t, double X)
-    { // Diffusion term
-    
-        double betaCEV = 1.0;
-        return data->sig * pow(X, betaCEV);
-        
-    }
-
-    double diffusionDerivative(double t, double X)
-    { // Diffusion term, needed for the Milstein method
+int main(int argc, char* argv[])
+{
+    std::cout <<  "1 factor MC, explicit Euler unless another scheme is chosen\n";
     
-        double betaCEV = 1.0;
-        return 0.5 * (data->sig) * (betaCEV) * pow(X, 2.0 * betaCEV - 1.0);
+    // Non-interactive run: main NT NSim [seed] [threads] [generator] [reduction] [scheme] [lockstep]
+    // generator 0 = boost, 1 = ziggurat, 2 = Box-Muller, 3 = inverse cdf, 4 = Sobol QMC
+    // reduction 0 = none, 1 = antithetic, 2 = control variate, 3 = moment matching; all when omitted
+    // scheme 0 = Euler, 1 = Milstein, 2 = log-Euler, 3 = exact GBM
+    // lockstep 1 advances each block of paths one time step at a time
+    bool interactive = argc < 3;
+    MCSettings settings;
+    settings.seed = argc > 3 ? std::stoul(argv[3]) : 0;
+    settings.nThreads = argc > 4 ? std::stoi(argv[4]) : 0;
+    settings.method = argc > 5 ? (NormalMethod)std::stoi(argv[5]) : NormalMethod::Boost;
+    settings.scheme = argc > 7 ? (Scheme)std::stoi(argv[7]) : Scheme::Euler;
+    settings.lockstep = argc > 8 && std::stoi(argv[8]) != 0;
+    int firstMode = argc > 6 ? std::stoi(argv[6]) : 0;
+    int lastMode = argc > 6 ? firstMode : 3;
+    if (firstMode < 0 || firstMode > 3)
+    {
+        std::cerr << "reduction must be 0, 1, 2 or 3, got " << argv[6] << std::endl;
+        return 1;
     }
-} // End of namespace
-
-
-int main()
-{
-    std::cout <<  "1 factor MC with explicit Euler\n";
+    const char* modeNames[] = { "Plain", "Antithetic", "Control variate", "Moment matching" };
     
     // Store Batch 1 to Batch 2 data in a vector.
     typedef boost::tuple<double, double, double, double, double> TupleFive;
@@ -94,9 +84,6 @@ int main()
     vecBatch.push_back(boost::make_tuple(0.25, 65.0, 0.30, 0.08, 60.0));
     vecBatch.push_back(boost::make_tuple(1.00, 100.0, 0.20, 0.00, 100.0));
     
-    // Vector to store the prices of put and call.
-    vector<double> vecCallPrice, vecPutPrice;
-    
     for (int i = 0; i<vecBatch.size(); i++){
         OptionData myOption;
         myOption.T = vecBatch[i].get<0>();
@@ -104,97 +91,118 @@ int main()
         myOption.sig = vecBatch[i].get<2>();
         myOption.r = vecBatch[i].get<3>();
         myOption.type = 1;
-        double S_0 = vecBatch[i].get<4>();
-        
-        long N = 100;
-        std::cout << "Number of subintervals in time: ";
-        std::cin >> N;
-        
-        // Create the basic SDE (Context class)
-        Range<double> range (0.0, myOption.T);
-        double VOld = S_0;
-        double VNew;
-        
-        std::vector<double> x = range.mesh(N);
-        
-        
-        // V2 mediator stuff
-        long NSim = 50000;
-        std::cout << "Number of simulations: ";
-        std::cin >> NSim;
-        
-        double k = myOption.T / double (N);
-        double sqrk = sqrt(k);
-        
-        // Normal random number
-        double dW;
-        double price1 = 0.0;    // Call Option price
-        double price2 = 0.0;    // Put Option price
-        
-        
-        // NormalGenerator is a base class
-        NormalGenerator* myNormal = new BoostNormal();
-        
-        using namespace SDEDefinition;
-        SDEDefinition::data = &myOption;
-        
-        std::vector<double> res;
-        int coun = 0; // Number of times S hits origin
-        
-        // A.
-        for (long i = 1; i <= NSim; ++i)
-        { // Calculate a path at each iteration
-            
-            if ((i/10000) * 10000 == i)
-            {// Give status after each 1000th iteration
-                
-                std::cout << i << std::endl;
-            }
-            
-            VOld = S_0;
-            for (unsigned long index = 1; index < x.size(); ++index)
-            {
-                
-                // Create a random number
-                dW = myNormal->getNormal();
-                
-                // The FDM (in this case explicit Euler)
-                VNew = VOld  + (k * drift(x[index-1], VOld))
-                + (sqrk * diffusion(x[index-1], VOld) * dW);
-                
-                VOld = VNew;
-                
-                // Spurious values
-                if (VNew <= 0.0) coun++;
-            }
-            
-            double tmp1 = myOption.myPayOffFunction(VNew);
-            price1 += (tmp1)/double(NSim);
-            vecCallPrice.push_back(tmp1);
-            myOption.type = -1;
-            double tmp2 = myOption.myPayOffFunction(VNew);
-            price2 += (tmp2) / double(NSim);
-            vecPutPrice.push_back(tmp2);
-            myOption.type = 1;
-            
+        myOption.S = vecBatch[i].get<4>();
+        myOption.D = 0.0;
+        
+        long N = interactive ? 100 : std::stol(argv[1]);
+        long NSim = interactive ? 50000 : std::stol(argv[2]);
+        if (interactive)
+        {
+            std::cout << "Number of subintervals in time: ";
+            std::cin >> N;
+            std::cout << "Number of simulations: ";
+            std::cin >> NSim;
         }
         
-        // D. Finally, discounting the average price
-        price1 *= exp(-myOption.r * myOption.T);
-        price2 *= exp(-myOption.r * myOption.T);
-        
-        // Cleanup; V2 use scoped pointer
-        delete myNormal;
-        
-        //compute sd and se for batch 1
-        boost::tuple<double, double> tupleCall = SDSE<double>(vecCallPrice, myOption.r, myOption.T);
-        boost::tuple<double, double> tuplePut = SDSE<double>(vecPutPrice, myOption.r, myOption.T);
-        std::cout << "Batch " << i + 1 << ", Call: NT = " << N << ", NSIM = " << NSim
-        << ", SD = " << tupleCall.get<0>() << ", SE = " << tupleCall.get<1>() << endl;
-       std::cout << "Batch " << i + 1 << ", Put: NT = " << N << ", NSIM = " << NSim
-        << ", SD = " << tuplePut.get<0>() << ", SE = " << tuplePut.get<1>() << endl;
-        
+        for (int mode = firstMode; mode <= lastMode; ++mode)
+        {
+            if (settings.method == NormalMethod::Sobol && (VarianceReduction)mode == VarianceReduction::MomentMatching)
+                continue;   // not defined for QMC points
+
+            // Paths are split across threads, the result only depends on the seed
+            settings.NT = N;
+            settings.NSim = NSim;
+            settings.reduction = (VarianceReduction)mode;
+            MonteCarloEngine<GBM> engine(myOption, GBM(myOption), settings);
+            MCResult result = engine.run();
+
+            // Moment matching samples the block means, whose SD is not comparable to a per-path SD
+            std::pair<double, double> callCI = result.call.confidenceInterval();
+            std::pair<double, double> putCI = result.put.confidenceInterval();
+            const char* sd = settings.reduction == VarianceReduction::MomentMatching ? ", SD of block means = " : ", SD = ";
+            std::cout << modeNames[mode] << endl;
+            std::cout << "Batch " << i + 1 << ", Call: NT = " << N << ", NSIM = " << NSim << ", Price = " << result.call.mean()
+            << sd << result.call.SD() << ", SE = " << result.call.SE()
+            << ", 95% CI = [" << callCI.first << ", " << callCI.second << "], VRF = " << formatVRF(result.callVRF) << endl;
+            std::cout << "Batch " << i + 1 << ", Put: NT = " << N << ", NSIM = " << NSim << ", Price = " << result.put.mean()
+            << sd << result.put.SD() << ", SE = " << result.put.SE()
+            << ", 95% CI = [" << putCI.first << ", " << putCI.second << "], VRF = " << formatVRF(result.putVRF) << endl;
+            std::cout << "Number of times S hits origin: " << result.hitsOrigin << endl;
+        }
+
+        // Crank-Nicolson on the same batch, and the early exercise premium;
+        // sinh mesh with Richardson extrapolation, greeks from the grid
+        FDMSettings fdmSettings;
+        fdmSettings.NS = 200;
+        fdmSettings.extrapolate = true;
+        FDMEngine fdm(fdmSettings);
+        OptionData fdmOption = myOption;
+        for (int type : { 1, -1 })
+        {
+            fdmOption.type = type;
+            FDMResult american = fdm.price(fdmOption, ExerciseStyle::American);
+            std::cout << "Batch " << i + 1 << (type == 1 ? ", Call" : ", Put") << ": FDM European = "
+            << fdm.price(fdmOption, ExerciseStyle::European).price << ", American = " << american.price
+            << " (delta " << american.delta << ", gamma " << american.gamma << ", theta " << american.theta
+            << "), Exact = " << BlackScholesPrice(fdmOption, type) << endl;
+        }
     }
-    
-    return 0;
+
+    // Down-and-out call against the closed form, at and below the barrier the
+    // option is knocked out and worth zero
+    int failures = 0;
+    FDMSettings barrierSettings;
+    barrierSettings.NS = 400;
+    barrierSettings.NT = 400;
+    barrierSettings.downAndOut = true;
+    barrierSettings.extrapolate = true;
+    FDMEngine barrierFdm(barrierSettings);
+    OptionData barrier;
+    barrier.K = 100.0; barrier.H = 90.0; barrier.T = 1.0; barrier.r = 0.05; barrier.sig = 0.2; barrier.D = 0.02;
+    barrier.type = 1;
+    for (double S : { 80.0, 89.0, 90.0, 91.0, 95.0, 100.0, 110.0, 130.0 })
+    {
+        barrier.S = S;
+        FDMResult fdmResult = barrierFdm.price(barrier, ExerciseStyle::European);
+        double exact = DownAndOutCallPrice(barrier);
+        bool ok = std::abs(fdmResult.price - exact) <= 1e-3 * std::max(1.0, exact)
+            && (S > barrier.H || (fdmResult.delta == 0.0 && fdmResult.gamma == 0.0));
+        failures += ok ? 0 : 1;
+        std::cout << "FDM down-and-out call, H = " << barrier.H << ", S = " << S << ": FDM = " << fdmResult.price
+        << ", Exact = " << exact << (ok ? "" : "  MISMATCH") << endl;
+    }
+
+    // The same option without dividend by Monte Carlo, path by path and in
+    // lockstep. The barrier is watched on the time nodes only, which the closed
+    // form matches with the barrier moved down to H exp(-0.5826 sig sqrt(k))
+    // (Broadie, Glasserman, Kou); log-Euler and exact GBM are exact on the nodes
+    MCSettings barrierMC = settings;
+    barrierMC.NT = 200;
+    barrierMC.NSim = 200000;
+    barrierMC.reduction = VarianceReduction::None;
+    barrierMC.downAndOut = true;
+    barrier.S = 100.0;
+    barrier.D = 0.0;
+    OptionData shifted = barrier;
+    shifted.H = barrier.H * exp(-0.5826 * barrier.sig * sqrt(barrier.T / double(barrierMC.NT)));
+    for (Scheme scheme : { Scheme::LogEuler, Scheme::ExactGBM })
+        for (bool lockstep : { false, true })
+        {
+            barrierMC.scheme = scheme;
+            barrierMC.lockstep = lockstep;
+            GBM gbm(barrier);
+            MCResult mc = MonteCarloEngine<GBM>(barrier, gbm, barrierMC).run();
+            double exact = DownAndOutCallPrice(shifted);
+            bool ok = std::abs(mc.call.mean() - exact) <= 4.0 * mc.call.SE() + 0.02;
+            failures += ok ? 0 : 1;
+            std::cout << "MC down-and-out call, H = " << barrier.H << (scheme == Scheme::ExactGBM ? ", exact GBM" : ", log-Euler")
+            << (lockstep ? ", lockstep" : ", path by path") << ": Price = " << mc.call.mean() << ", SE = " << mc.call.SE()
+            << ", Exact (monitored on " << barrierMC.NT << " nodes) = " << exact << (ok ? "" : "  MISMATCH") << endl;
+        }
+
+    // Engine counters and phase timers, empty unless built with PRICING_METRICS=1
+    if (metrics::enabled)
+        std::cout << std::endl << metrics::snapshot().text();
+
+    return failures > 0 ? 1 : 0;
 }